@@ -0,0 +1,81 @@
+#include "ChunkMesher.h"
+#include <chrono>
+#include <memory>
+
+ChunkMesher::ChunkMesher(ThreadPool* pThreadPool)
+	:m_pThreadPool{pThreadPool}
+{
+}
+
+void ChunkMesher::Submit(size_t chunkId, const VoxelChunk& chunk, MeshingMode mode, VoxelVertexFormat format, int lod, const VoxelChunkNeighbours& neighbours)
+{
+	uint64_t jobId{};
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		jobId = m_NextJobId++;
+		m_LatestJobIds[chunkId] = jobId;
+		m_PendingCount++;
+	}
+
+	//The snapshot shares the voxel data, an edit on the main thread copies it first.
+	std::shared_ptr<const VoxelChunk> pSnapshot = std::make_shared<const VoxelChunk>(chunk.GetSharedData(), chunk.GetPosition());
+	m_pThreadPool->Submit([this, pSnapshot, chunkId, jobId, mode, format, lod, neighbours]()
+	{
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		ChunkMeshResult result{};
+		result.ChunkId = chunkId;
+		result.JobId = jobId;
+		pSnapshot->GenerateMesh(result.Mesh, mode, format, lod, neighbours);
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+		result.MeshingTime = std::chrono::duration<float>(t2 - t1).count() * 1000;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_PendingCount--;
+		std::unordered_map<size_t, uint64_t>::iterator latestJob = m_LatestJobIds.find(chunkId);
+		if (latestJob != m_LatestJobIds.end() && latestJob->second == jobId)
+		{
+			m_Results.push_back(std::move(result));
+		}
+	});
+}
+
+void ChunkMesher::PopResults(std::vector<ChunkMeshResult>& results, size_t maxCount)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	size_t resultId = 0;
+	for (size_t popCount = 0; resultId < m_Results.size() && popCount < maxCount; resultId++)
+	{
+		//The chunk might have been submitted again or cancelled after this mesh finished.
+		ChunkMeshResult& result = m_Results[resultId];
+		std::unordered_map<size_t, uint64_t>::iterator latestJob = m_LatestJobIds.find(result.ChunkId);
+		if (latestJob == m_LatestJobIds.end() || latestJob->second != result.JobId)
+			continue;
+		m_LatestJobIds.erase(latestJob);
+		results.push_back(std::move(result));
+		popCount++;
+	}
+	m_Results.erase(m_Results.begin(), m_Results.begin() + resultId);
+}
+
+void ChunkMesher::Cancel(size_t chunkId)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_LatestJobIds.erase(chunkId);
+}
+
+void ChunkMesher::Wait()
+{
+	m_pThreadPool->Wait();
+}
+
+size_t ChunkMesher::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_PendingCount;
+}
+
+bool ChunkMesher::IsPending(size_t chunkId)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_LatestJobIds.find(chunkId) != m_LatestJobIds.end();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "VoxelChunk.h"
+#include <Base/ThreadPool.h>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+struct ChunkMeshResult
+{
+	size_t		ChunkId{};
+	VoxelMesh	Mesh{};
+	float		MeshingTime{};	//ms spent on the worker
+	uint64_t	JobId{};
+};
+
+//Meshes chunks on a thread pool. Every job works on a snapshot of the chunk taken at submission, so the chunk can keep being edited
+//and rendered while it is meshed. Finished meshes are collected with PopResults on the render thread.
+class ChunkMesher
+{
+public:
+	explicit ChunkMesher(ThreadPool* pThreadPool);
+
+	//Levels of detail above 0 mesh a downsampled copy of the chunk, see VoxelChunk::GenerateMesh. The neighbours are snapshotted
+	//along with the chunk.
+	void Submit(size_t chunkId, const VoxelChunk& chunk, MeshingMode mode, VoxelVertexFormat format, int lod = 0, const VoxelChunkNeighbours& neighbours = {});
+	//Moves up to maxCount finished meshes into results, the rest stay queued for the next call. Meshes made obsolete by a newer
+	//submission of the same chunk are dropped.
+	void PopResults(std::vector<ChunkMeshResult>& results, size_t maxCount = SIZE_MAX);
+	//Drops the mesh of a chunk in flight, for chunks that are removed. The chunk id can be submitted again right away.
+	void Cancel(size_t chunkId);
+	//Blocks until every submitted chunk has been meshed.
+	void Wait();
+	size_t GetPendingCount();
+	//True from submission until the chunk's mesh is popped.
+	bool IsPending(size_t chunkId);
+
+private:
+	ThreadPool*									m_pThreadPool = nullptr;
+	std::mutex									m_Mutex{};
+	std::vector<ChunkMeshResult>				m_Results{};
+	std::unordered_map<size_t, uint64_t>		m_LatestJobIds{};	//Only holds chunks with a job in flight
+	uint64_t									m_NextJobId{};
+	size_t										m_PendingCount{};
+};
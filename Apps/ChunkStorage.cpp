@@ -0,0 +1,346 @@
+#include "ChunkStorage.h"
+#include <DataHandling/Helper.h>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+//Region files are little endian: the header, RegionChunkCount ChunkEntry structs and the chunk data.
+struct RegionHeader
+{
+	uint32_t Magic{};
+	uint32_t Version{};
+	uint32_t ChunkSize{};
+	uint32_t RegionSize{};
+};
+
+const uint32_t RegionMagic = 0x47525856; //"VXRG"
+const uint32_t RegionVersion = 1;
+
+static void WriteVarint(std::vector<uint8_t>& data, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back(uint8_t(value));
+}
+
+static bool ReadVarint(const uint8_t*& pData, const uint8_t* pEnd, uint32_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35 && pData < pEnd; shift += 7)
+	{
+		const uint8_t byte = *pData++;
+		value |= uint32_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+ChunkStorage::ChunkStorage(const std::string& pathPrefix, int chunkSize)
+	:m_PathPrefix{ pathPrefix }
+	,m_ChunkSize{ chunkSize }
+{
+	m_Writer = std::thread(&ChunkStorage::WriterLoop, this);
+}
+
+ChunkStorage::~ChunkStorage()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_ChunksQueued.notify_one();
+	m_Writer.join();
+}
+
+void ChunkStorage::SaveChunk(const glm::ivec3& chunkCoord, const std::shared_ptr<VoxelChunkData>& pData)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_QueuedChunks[chunkCoord] = pData;
+		m_HasNewChunks = true;
+	}
+	m_ChunksQueued.notify_one();
+}
+
+bool ChunkStorage::LoadChunk(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels)
+{
+	assert(voxels.GetWidth() == size_t(m_ChunkSize) && voxels.GetHeight() == size_t(m_ChunkSize) && voxels.GetDepth() == size_t(m_ChunkSize) && "Voxels do not match the chunk size!");
+	std::shared_ptr<VoxelChunkData> pQueuedData;
+	Region* pRegion = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto queuedChunk = m_QueuedChunks.find(chunkCoord);
+		if (queuedChunk != m_QueuedChunks.end())
+			pQueuedData = queuedChunk->second;
+		else
+			pRegion = &GetRegion(GetRegionCoord(chunkCoord));
+	}
+	if (pQueuedData)
+	{
+		pQueuedData->Voxels.CopyTo(voxels);
+		return true;
+	}
+
+	std::shared_lock<std::shared_timed_mutex> readLock(pRegion->Mutex);
+	ChunkEntry entry{};
+	if (!GetChunkEntry(pRegion->File, GetChunkIndex(chunkCoord), entry))
+		return false;
+	return DecodeChunk(pRegion->File.GetData() + entry.Offset, entry.Size, voxels);
+}
+
+void ChunkStorage::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_ChunksWritten.wait(lock, [this]() { return !m_HasNewChunks && !m_IsWriting; });
+}
+
+size_t ChunkStorage::GetQueuedCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_QueuedChunks.size();
+}
+
+std::string ChunkStorage::GetRegionFilename(const glm::ivec3& regionCoord) const
+{
+	return m_PathPrefix + std::to_string(regionCoord.x) + "." + std::to_string(regionCoord.y) + "." + std::to_string(regionCoord.z) + ".region";
+}
+
+ChunkStorage::Region& ChunkStorage::GetRegion(const glm::ivec3& regionCoord)
+{
+	std::unique_ptr<Region>& pRegion = m_Regions[regionCoord];
+	if (!pRegion)
+	{
+		pRegion.reset(new Region{});
+		//A missing file is a region without saved chunks.
+		pRegion->File.Open(GetRegionFilename(regionCoord));
+	}
+	return *pRegion;
+}
+
+int ChunkStorage::GetChunkIndex(const glm::ivec3& chunkCoord)
+{
+	const glm::ivec3 localCoord = chunkCoord & (RegionSize - 1);
+	return (localCoord.x * RegionSize + localCoord.y) * RegionSize + localCoord.z;
+}
+
+bool ChunkStorage::GetChunkEntry(const MappedFile& file, int chunkIndex, ChunkEntry& entry) const
+{
+	const size_t tableEnd = sizeof(RegionHeader) + RegionChunkCount * sizeof(ChunkEntry);
+	if (!file.IsOpen() || file.GetSize() < tableEnd)
+		return false;
+	RegionHeader header{};
+	memcpy(&header, file.GetData(), sizeof(RegionHeader));
+	if (header.Magic != RegionMagic || header.Version != RegionVersion || header.ChunkSize != uint32_t(m_ChunkSize) || header.RegionSize != uint32_t(RegionSize))
+		return false;
+	memcpy(&entry, file.GetData() + sizeof(RegionHeader) + chunkIndex * sizeof(ChunkEntry), sizeof(ChunkEntry));
+	return entry.Size > 0 && entry.Offset >= tableEnd && size_t(entry.Offset) + entry.Size <= file.GetSize();
+}
+
+void ChunkStorage::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_ChunksQueued.wait(lock, [this]() { return m_HasNewChunks || m_IsStopping; });
+		if (!m_HasNewChunks)
+			break;
+		m_HasNewChunks = false;
+		m_IsWriting = true;
+		std::unordered_map<glm::ivec3, std::vector<QueuedChunk>, ChunkCoordHash> regionChunks;
+		for (const auto& chunk : m_QueuedChunks)
+		{
+			regionChunks[GetRegionCoord(chunk.first)].push_back(QueuedChunk{ chunk.first, chunk.second });
+		}
+		lock.unlock();
+
+		std::vector<QueuedChunk> writtenChunks;
+		for (const auto& region : regionChunks)
+		{
+			if (!WriteRegion(region.first, region.second))
+				continue;
+			writtenChunks.insert(writtenChunks.end(), region.second.begin(), region.second.end());
+		}
+
+		lock.lock();
+		//Chunks saved again meanwhile stay queued for the next write. Chunks of a region that failed to write stay queued as well,
+		//they are retried with the next save.
+		for (const QueuedChunk& chunk : writtenChunks)
+		{
+			auto queuedChunk = m_QueuedChunks.find(chunk.first);
+			if (queuedChunk != m_QueuedChunks.end() && queuedChunk->second == chunk.second)
+				m_QueuedChunks.erase(queuedChunk);
+		}
+		m_IsWriting = false;
+		m_ChunksWritten.notify_all();
+	}
+}
+
+bool ChunkStorage::WriteRegion(const glm::ivec3& regionCoord, const std::vector<QueuedChunk>& chunks)
+{
+	std::vector<int> queuedChunkIds(RegionChunkCount, -1);
+	std::vector<std::vector<uint8_t>> encodedChunks(chunks.size());
+	uint64_t queuedSize = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		queuedChunkIds[GetChunkIndex(chunks[i].first)] = int(i);
+		EncodeChunk(chunks[i].second->Voxels, encodedChunks[i]);
+		queuedSize += encodedChunks[i].size();
+	}
+	Region* pRegion = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		pRegion = &GetRegion(regionCoord);
+	}
+
+	//Only this thread writes region files, so the file does not change between this look at it and the write.
+	uint64_t fileSize = 0;
+	uint64_t usedSize = 0;
+	bool isValid = false;
+	{
+		std::shared_lock<std::shared_timed_mutex> readLock(pRegion->Mutex);
+		ChunkEntry entry{};
+		for (int i = 0; i < RegionChunkCount; i++)
+		{
+			if (GetChunkEntry(pRegion->File, i, entry))
+			{
+				isValid = true;
+				if (queuedChunkIds[i] < 0)
+					usedSize += entry.Size;
+			}
+		}
+		fileSize = pRegion->File.GetSize();
+	}
+
+	const std::string filename = GetRegionFilename(regionCoord);
+	const uint64_t tableEnd = sizeof(RegionHeader) + RegionChunkCount * sizeof(ChunkEntry);
+	const uint64_t unusedSize = isValid ? fileSize - tableEnd - usedSize : 0;
+	bool isWritten = false;
+	if (isValid && unusedSize <= usedSize + queuedSize && fileSize + queuedSize <= UINT32_MAX)
+		isWritten = AppendChunks(*pRegion, filename, fileSize, chunks, encodedChunks);
+	else
+		isWritten = RewriteRegion(*pRegion, filename, queuedChunkIds, encodedChunks);
+	//Not fatal, the chunks stay queued and the write is retried with the next save.
+	if (!isWritten)
+		std::cout << "Warning: Failed to write region file " << filename << ", its chunks stay queued!" << std::endl;
+	return isWritten;
+}
+
+bool ChunkStorage::AppendChunks(Region& region, const std::string& filename, uint64_t fileSize, const std::vector<QueuedChunk>& chunks, const std::vector<std::vector<uint8_t>>& encodedChunks)
+{
+	std::vector<ChunkEntry> entries(chunks.size());
+	std::vector<FileWrite> dataWrites(chunks.size());
+	std::vector<FileWrite> tableWrites(chunks.size());
+	uint64_t offset = fileSize;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		entries[i] = { uint32_t(offset), uint32_t(encodedChunks[i].size()) };
+		dataWrites[i] = { offset, encodedChunks[i].data(), encodedChunks[i].size() };
+		tableWrites[i] = { sizeof(RegionHeader) + GetChunkIndex(chunks[i].first) * sizeof(ChunkEntry), &entries[i], sizeof(ChunkEntry) };
+		offset += encodedChunks[i].size();
+	}
+
+	//The data is on the disk before the table points at it, a failed or interrupted write leaves the old chunks readable.
+	std::unique_lock<std::shared_timed_mutex> writeLock(region.Mutex);
+	region.File.Close();
+	const bool isWritten = WriteFileRegions(filename, dataWrites) && WriteFileRegions(filename, tableWrites);
+	region.File.Open(filename);
+	return isWritten;
+}
+
+bool ChunkStorage::RewriteRegion(Region& region, const std::string& filename, const std::vector<int>& queuedChunkIds, const std::vector<std::vector<uint8_t>>& encodedChunks)
+{
+	//The new file takes the saved chunks from the old one and the queued chunks from memory.
+	RegionHeader header{ RegionMagic, RegionVersion, uint32_t(m_ChunkSize), uint32_t(RegionSize) };
+	std::vector<uint8_t> data(sizeof(RegionHeader) + RegionChunkCount * sizeof(ChunkEntry));
+	memcpy(data.data(), &header, sizeof(RegionHeader));
+	{
+		std::shared_lock<std::shared_timed_mutex> readLock(region.Mutex);
+		for (int i = 0; i < RegionChunkCount; i++)
+		{
+			const uint8_t* pChunkData = nullptr;
+			ChunkEntry entry{};
+			if (queuedChunkIds[i] >= 0)
+			{
+				const std::vector<uint8_t>& encodedChunk = encodedChunks[queuedChunkIds[i]];
+				pChunkData = encodedChunk.data();
+				entry.Size = uint32_t(encodedChunk.size());
+			}
+			else if (GetChunkEntry(region.File, i, entry))
+			{
+				pChunkData = region.File.GetData() + entry.Offset;
+			}
+			if (!pChunkData)
+				continue;
+			//Offsets are 32 bits, a region that does not fit can not be written.
+			if (uint64_t(data.size()) + entry.Size > UINT32_MAX)
+				return false;
+			entry.Offset = uint32_t(data.size());
+			memcpy(data.data() + sizeof(RegionHeader) + i * sizeof(ChunkEntry), &entry, sizeof(ChunkEntry));
+			data.insert(data.end(), pChunkData, pChunkData + entry.Size);
+		}
+	}
+
+	//Windows can not replace a file that is still mapped, so loads from this region wait until the new file is mapped.
+	std::unique_lock<std::shared_timed_mutex> writeLock(region.Mutex);
+	region.File.Close();
+	const bool isWritten = WriteFileAtomic(filename, data.data(), data.size());
+	region.File.Open(filename);
+	return isWritten;
+}
+
+void ChunkStorage::EncodeChunk(const BrickMap& voxels, std::vector<uint8_t>& data) const
+{
+	const int size = m_ChunkSize;
+	std::vector<uint32_t> values(size_t(size) * size * size);
+	voxels.Read({ 0, 0, 0 }, { size, size, size }, values.data());
+	data.clear();
+	uint32_t runValue = values[0];
+	uint32_t runLength = 0;
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			for (int y = 0; y < size; y++)
+			{
+				const uint32_t value = values[(size_t(x) * size + y) * size + z];
+				if (value != runValue)
+				{
+					WriteVarint(data, runLength);
+					WriteVarint(data, runValue);
+					runValue = value;
+					runLength = 0;
+				}
+				runLength++;
+			}
+		}
+	}
+	WriteVarint(data, runLength);
+	WriteVarint(data, runValue);
+}
+
+bool ChunkStorage::DecodeChunk(const uint8_t* pData, size_t size, Array3D<uint32_t>& voxels) const
+{
+	const uint8_t* pEnd = pData + size;
+	const int chunkSize = m_ChunkSize;
+	uint32_t* pValues = voxels.Data();
+	uint32_t runValue = 0;
+	uint32_t runLength = 0;
+	for (int x = 0; x < chunkSize; x++)
+	{
+		for (int z = 0; z < chunkSize; z++)
+		{
+			for (int y = 0; y < chunkSize; y++)
+			{
+				if (runLength == 0 && (!ReadVarint(pData, pEnd, runLength) || !ReadVarint(pData, pEnd, runValue) || runLength == 0))
+					return false;
+				pValues[(size_t(x) * chunkSize + y) * chunkSize + z] = runValue;
+				runLength--;
+			}
+		}
+	}
+	return runLength == 0 && pData == pEnd;
+}
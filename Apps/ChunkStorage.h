@@ -0,0 +1,86 @@
+#pragma once
+#include "VoxelWorld.h"
+#include <DataHandling/MappedFile.h>
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+const int RegionShift = 5;
+//Chunks per axis in one region file.
+const int RegionSize = 1 << RegionShift;
+const int RegionChunkCount = RegionSize * RegionSize * RegionSize;
+
+//Persists chunks in region files of RegionSize^3 chunks. A region file holds a header, a table with the offset and size of every
+//chunk and the run length encoded voxels of the chunks saved so far. Region files are memory mapped, so loading a chunk only touches
+//the pages of its table entry and its voxels. Saves are queued and written by a background thread, queued chunks are loaded from
+//memory until they are written. Saved chunks are appended to their region file and the table is patched, the whole file is only
+//rewritten without the replaced chunks once they take more room than the chunks still in use.
+class ChunkStorage
+{
+public:
+	//Region files are named pathPrefix followed by the region coordinate.
+	ChunkStorage(const std::string& pathPrefix, int chunkSize);
+	//Writes the queued chunks before returning.
+	~ChunkStorage();
+	ChunkStorage(const ChunkStorage&) = delete;
+	ChunkStorage& operator=(const ChunkStorage&) = delete;
+
+	//Queues the chunk and returns right away. The data is kept alive until it is written, an edit of the chunk copies it first.
+	void SaveChunk(const glm::ivec3& chunkCoord, const std::shared_ptr<VoxelChunkData>& pData);
+	//Returns false when the chunk was never saved. Can be called from any thread.
+	bool LoadChunk(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels);
+	//Blocks until the background thread wrote every queued chunk.
+	void Flush();
+	size_t GetQueuedCount();
+	std::string GetRegionFilename(const glm::ivec3& regionCoord) const;
+	static glm::ivec3 GetRegionCoord(const glm::ivec3& chunkCoord) { return chunkCoord >> RegionShift; }
+
+private:
+	struct Region
+	{
+		std::shared_timed_mutex	Mutex{};	//Shared while chunks are read from the file, exclusive while it is replaced
+		MappedFile				File{};
+	};
+	struct ChunkEntry
+	{
+		uint32_t Offset{};
+		uint32_t Size{};	//0 when the chunk was never saved
+	};
+	using QueuedChunk = std::pair<glm::ivec3, std::shared_ptr<VoxelChunkData>>;
+
+	//Opens the region file the first time the region is used. m_Mutex must be locked.
+	Region& GetRegion(const glm::ivec3& regionCoord);
+	static int GetChunkIndex(const glm::ivec3& chunkCoord);
+	//Table entry of the chunk in a mapped region file, false when the file is missing, invalid or does not hold the chunk.
+	bool GetChunkEntry(const MappedFile& file, int chunkIndex, ChunkEntry& entry) const;
+	void WriterLoop();
+	//Stores the given chunks in the region file, returns false when the file could not be written.
+	bool WriteRegion(const glm::ivec3& regionCoord, const std::vector<QueuedChunk>& chunks);
+	//Appends the encoded chunks to the valid region file of fileSize bytes and points their table entries at them.
+	bool AppendChunks(Region& region, const std::string& filename, uint64_t fileSize, const std::vector<QueuedChunk>& chunks, const std::vector<std::vector<uint8_t>>& encodedChunks);
+	//Replaces the region file with one that holds the chunks still in use in the old one and the encoded chunks, without any unused room.
+	bool RewriteRegion(Region& region, const std::string& filename, const std::vector<int>& queuedChunkIds, const std::vector<std::vector<uint8_t>>& encodedChunks);
+	//Runs of equal voxels, walking up the columns since terrain changes the least along them.
+	void EncodeChunk(const BrickMap& voxels, std::vector<uint8_t>& data) const;
+	bool DecodeChunk(const uint8_t* pData, size_t size, Array3D<uint32_t>& voxels) const;
+
+	std::string						m_PathPrefix{};
+	int								m_ChunkSize{};
+	std::mutex						m_Mutex{};
+	std::unordered_map<glm::ivec3, std::unique_ptr<Region>, ChunkCoordHash>	m_Regions{};
+	//Latest save of every chunk that is not in its region file yet.
+	std::unordered_map<glm::ivec3, std::shared_ptr<VoxelChunkData>, ChunkCoordHash>	m_QueuedChunks{};
+	bool							m_HasNewChunks{ false };
+	bool							m_IsWriting{ false };
+	bool							m_IsStopping{ false };
+	std::condition_variable			m_ChunksQueued{};
+	std::condition_variable			m_ChunksWritten{};
+	std::thread						m_Writer{};
+};
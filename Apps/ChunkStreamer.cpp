@@ -0,0 +1,178 @@
+#include "ChunkStreamer.h"
+#include "ChunkStorage.h"
+#include <Base/ThreadPool.h>
+#include <algorithm>
+#include <iterator>
+
+ChunkStreamer::ChunkStreamer(VoxelWorld* pWorld, ThreadPool* pThreadPool, const ChunkGenerator& generator, const ChunkStreamingSettings& settings)
+	:m_pWorld{ pWorld }
+	,m_pThreadPool{ pThreadPool }
+	,m_Generator{ generator }
+	,m_Settings{ settings }
+{
+	assert(m_Settings.UnloadRadius >= m_Settings.LoadRadius && "Chunks would be removed right after being loaded!");
+}
+
+void ChunkStreamer::SetSettings(const ChunkStreamingSettings& settings)
+{
+	assert(settings.UnloadRadius >= settings.LoadRadius && "Chunks would be removed right after being loaded!");
+	m_Settings = settings;
+	m_AreQueuesValid = false;
+}
+
+void ChunkStreamer::Update(const glm::vec3& cameraPosition, const glm::vec3& cameraDirection, std::vector<size_t>& addedChunks, std::vector<size_t>& removedChunks)
+{
+	const glm::ivec3 cameraChunk = glm::ivec3(glm::floor(cameraPosition / float(m_pWorld->GetChunkSize())));
+	if (!m_AreQueuesValid || cameraChunk != m_CameraChunk)
+	{
+		m_CameraChunk = cameraChunk;
+		UpdateQueues();
+	}
+
+	//Removals first, so the added chunks can reuse their ids.
+	for (int removedCount = 0; removedCount < m_Settings.MaxRemovedChunks && !m_ChunksToRemove.empty();)
+	{
+		const glm::ivec3 chunkCoord = m_ChunksToRemove.back();
+		m_ChunksToRemove.pop_back();
+		const size_t chunkId = m_pWorld->GetChunkId(chunkCoord);
+		if (chunkId == VoxelWorld::InvalidChunkId)
+			continue;
+		const VoxelChunk* pChunk = m_pWorld->GetChunk(chunkId);
+		if (m_pStorage && pChunk->IsModified())
+			m_pStorage->SaveChunk(chunkCoord, pChunk->GetSharedData());
+		m_pWorld->RemoveChunk(chunkId);
+		removedChunks.push_back(chunkId);
+		removedCount++;
+	}
+
+	std::vector<GeneratedChunk> generatedChunks;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const size_t addCount = std::min(m_GeneratedChunks.size(), size_t(m_Settings.MaxAddedChunks));
+		std::move(m_GeneratedChunks.begin(), m_GeneratedChunks.begin() + addCount, std::back_inserter(generatedChunks));
+		m_GeneratedChunks.erase(m_GeneratedChunks.begin(), m_GeneratedChunks.begin() + addCount);
+	}
+	for (const GeneratedChunk& chunk : generatedChunks)
+	{
+		m_GeneratingChunks.erase(chunk.ChunkCoord);
+		//The camera might have moved away while the chunk was generated.
+		if (!IsInRadius(chunk.ChunkCoord, m_Settings.UnloadRadius))
+			continue;
+		addedChunks.push_back(m_pWorld->AddChunk(chunk.ChunkCoord, chunk.Voxels));
+	}
+
+	SubmitChunks(cameraPosition, cameraDirection);
+}
+
+void ChunkStreamer::SaveModifiedChunks()
+{
+	if (!m_pStorage)
+		return;
+	for (size_t i = 0; i < m_pWorld->GetChunkCount(); i++)
+	{
+		VoxelChunk* pChunk = m_pWorld->GetChunk(i);
+		if (!pChunk || !pChunk->IsModified())
+			continue;
+		m_pStorage->SaveChunk(m_pWorld->GetChunkCoord(i), pChunk->GetSharedData());
+		pChunk->ClearModified();
+	}
+}
+
+void ChunkStreamer::UpdateQueues()
+{
+	m_MissingChunks.clear();
+	const int radius = m_Settings.LoadRadius;
+	for (int x = -radius; x <= radius; x++)
+	{
+		for (int y = -radius; y <= radius; y++)
+		{
+			for (int z = -radius; z <= radius; z++)
+			{
+				const glm::ivec3 chunkCoord = m_CameraChunk + glm::ivec3{ x, y, z };
+				if (IsInRadius(chunkCoord, radius) && !m_pWorld->GetChunk(chunkCoord) && m_GeneratingChunks.find(chunkCoord) == m_GeneratingChunks.end())
+					m_MissingChunks.push_back(chunkCoord);
+			}
+		}
+	}
+
+	m_ChunksToRemove.clear();
+	for (size_t i = 0; i < m_pWorld->GetChunkCount(); i++)
+	{
+		if (!m_pWorld->GetChunk(i))
+			continue;
+		const glm::ivec3 chunkCoord = m_pWorld->GetChunkCoord(i);
+		if (!IsInRadius(chunkCoord, m_Settings.UnloadRadius))
+			m_ChunksToRemove.push_back(chunkCoord);
+	}
+	m_AreQueuesValid = true;
+}
+
+bool ChunkStreamer::IsInRadius(const glm::ivec3& chunkCoord, int radius) const
+{
+	const glm::ivec3 offset = chunkCoord - m_CameraChunk;
+	return offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius * radius;
+}
+
+int ChunkStreamer::GetChunkLod(const glm::ivec3& chunkCoord) const
+{
+	if (m_Settings.LodRadius <= 0)
+		return 0;
+	const glm::ivec3 offset = glm::abs(chunkCoord - m_CameraChunk);
+	const int distance = std::max(std::max(offset.x, offset.y), offset.z);
+	int lod = 0;
+	while (lod < MaxChunkLod && distance > m_Settings.LodRadius << lod)
+	{
+		lod++;
+	}
+	return lod;
+}
+
+float ChunkStreamer::GetPriority(const glm::ivec3& chunkCoord, const glm::vec3& cameraPosition, const glm::vec3& cameraDirection) const
+{
+	const float chunkSize = float(m_pWorld->GetChunkSize());
+	const glm::vec3 toChunk = (glm::vec3(chunkCoord) + 0.5f) * chunkSize - cameraPosition;
+	const float distance = glm::length(toChunk);
+	if (distance < chunkSize)
+		return distance;
+	const float facing = glm::dot(toChunk / distance, cameraDirection);
+	return distance * (1.5f - 0.5f * facing);
+}
+
+void ChunkStreamer::SubmitChunks(const glm::vec3& cameraPosition, const glm::vec3& cameraDirection)
+{
+	const size_t freeJobCount = size_t(std::max(m_Settings.MaxGenerateJobs - int(m_GeneratingChunks.size()), 0));
+	if (freeJobCount == 0 || m_MissingChunks.empty())
+		return;
+
+	//The view direction changes every frame, so the order is only decided for the jobs submitted now.
+	m_Candidates.clear();
+	for (const glm::ivec3& chunkCoord : m_MissingChunks)
+	{
+		m_Candidates.emplace_back(GetPriority(chunkCoord, cameraPosition, cameraDirection), chunkCoord);
+	}
+	const size_t submitCount = std::min(freeJobCount, m_Candidates.size());
+	std::partial_sort(m_Candidates.begin(), m_Candidates.begin() + submitCount, m_Candidates.end(),
+		[](const std::pair<float, glm::ivec3>& a, const std::pair<float, glm::ivec3>& b) { return a.first < b.first; });
+
+	const size_t chunkSize = size_t(m_pWorld->GetChunkSize());
+	for (size_t i = 0; i < submitCount; i++)
+	{
+		const glm::ivec3 chunkCoord = m_Candidates[i].second;
+		m_GeneratingChunks.insert(chunkCoord);
+		ChunkStorage* pStorage = m_pStorage;
+		m_pThreadPool->Submit([this, pStorage, chunkCoord, chunkSize]()
+		{
+			Array3D<uint32_t> voxels{ chunkSize, chunkSize, chunkSize };
+			if (!pStorage || !pStorage->LoadChunk(chunkCoord, voxels))
+				m_Generator(chunkCoord, voxels);
+			GeneratedChunk chunk{ chunkCoord, BrickMap{ voxels } };
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_GeneratedChunks.push_back(std::move(chunk));
+		});
+	}
+	m_MissingChunks.clear();
+	for (size_t i = submitCount; i < m_Candidates.size(); i++)
+	{
+		m_MissingChunks.push_back(m_Candidates[i].second);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "VoxelWorld.h"
+#include <Base/Array3D.h>
+#include <Base/BrickMap.h>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+class ChunkStorage;
+
+//Fills the voxels of the chunk at chunkCoord. Runs on the worker threads, so it must not touch shared state.
+using ChunkGenerator = std::function<void(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels)>;
+
+struct ChunkStreamingSettings
+{
+	int LoadRadius{ 6 };		//In chunks, missing chunks within this distance of the camera chunk are generated
+	int UnloadRadius{ 8 };		//Chunks further away are removed, the gap keeps chunks on the edge from being reloaded over and over
+	int MaxGenerateJobs{ 16 };	//Chunks generated on the workers or waiting to be added at once
+	int MaxAddedChunks{ 8 };	//Chunks added to the world per Update
+	int MaxRemovedChunks{ 32 };	//Chunks removed from the world per Update
+	int LodRadius{ 4 };			//Chunks up to this far from the camera chunk are full resolution, 0 keeps every chunk at full resolution
+};
+
+//Keeps the chunks around the camera resident in a VoxelWorld. Missing chunks are loaded or generated on a thread pool, nearest first and the ones
+//in view before the ones behind the camera, and chunks past the unload radius are removed. Every part of Update is capped, so moving
+//through the world spreads the work over frames instead of causing spikes.
+class ChunkStreamer
+{
+public:
+	ChunkStreamer(VoxelWorld* pWorld, ThreadPool* pThreadPool, const ChunkGenerator& generator, const ChunkStreamingSettings& settings = {});
+
+	//Removes and adds chunks within the per frame budget and queues new generation jobs. The ids of the removed chunks are added to
+	//removedChunks and those of the added chunks to addedChunks, an id can be in both when the slot was reused in the same Update.
+	void Update(const glm::vec3& cameraPosition, const glm::vec3& cameraDirection, std::vector<size_t>& addedChunks, std::vector<size_t>& removedChunks);
+	//Chunks are loaded from the storage when it has them and generated otherwise, modified chunks are saved to it before they are removed.
+	void SetStorage(ChunkStorage* pStorage) { m_pStorage = pStorage; }
+	//Queues every resident chunk that was modified since it was last saved.
+	void SaveModifiedChunks();
+	const ChunkStreamingSettings& GetSettings() const { return m_Settings; }
+	void SetSettings(const ChunkStreamingSettings& settings);
+	//Chunks within the load radius that are neither resident nor being generated.
+	size_t GetMissingCount() const { return m_MissingChunks.size(); }
+	size_t GetGeneratingCount() const { return m_GeneratingChunks.size(); }
+	const glm::ivec3& GetCameraChunk() const { return m_CameraChunk; }
+	//Level of detail of the chunk in clipmap rings around the camera chunk: full resolution up to LodRadius chunks away along any axis,
+	//then one level coarser every time the distance doubles, up to MaxChunkLod. The triangles per ring stay about the same, so
+	//the total grows with the logarithm of the view distance instead of its square.
+	int GetChunkLod(const glm::ivec3& chunkCoord) const;
+
+private:
+	struct GeneratedChunk
+	{
+		glm::ivec3	ChunkCoord{};
+		BrickMap	Voxels;
+	};
+
+	//Rebuilds the lists of missing chunks and chunks to remove once the camera entered another chunk.
+	void UpdateQueues();
+	bool IsInRadius(const glm::ivec3& chunkCoord, int radius) const;
+	//Lower is generated first: the distance to the camera, up to twice as far for chunks behind it.
+	float GetPriority(const glm::ivec3& chunkCoord, const glm::vec3& cameraPosition, const glm::vec3& cameraDirection) const;
+	void SubmitChunks(const glm::vec3& cameraPosition, const glm::vec3& cameraDirection);
+
+	VoxelWorld*						m_pWorld = nullptr;
+	ThreadPool*						m_pThreadPool = nullptr;
+	ChunkStorage*					m_pStorage = nullptr;
+	ChunkGenerator					m_Generator{};
+	ChunkStreamingSettings			m_Settings{};
+	glm::ivec3						m_CameraChunk{};
+	bool							m_AreQueuesValid{ false };
+	std::vector<glm::ivec3>			m_MissingChunks{};
+	std::vector<glm::ivec3>			m_ChunksToRemove{};
+	std::vector<std::pair<float, glm::ivec3>>	m_Candidates{};
+	//Submitted until added to the world or dropped, only touched on the calling thread.
+	std::unordered_set<glm::ivec3, ChunkCoordHash>	m_GeneratingChunks{};
+	std::mutex						m_Mutex{};
+	std::vector<GeneratedChunk>		m_GeneratedChunks{};
+};
@@ -179,7 +179,7 @@ void App::BuildDrawCommandBuffers()
 		vkCmdBindPipeline(m_DrawCommandBuffers["Wireframe"][i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pRenderPipelines["Wireframe"]->GetPipeline());
 		VkDeviceSize offsets[1] = { 0 };
 		vkCmdBindVertexBuffers(m_DrawCommandBuffers["Wireframe"][i], 0, 1, &m_pVertexBuffers["Color"]->GetBuffer().GetHandle(), offsets);
-		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Wireframe"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Wireframe"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, m_pIndexBuffer->GetIndexType());
 		vkCmdDrawIndexed(m_DrawCommandBuffers["Wireframe"][i], uint32_t(m_pIndexBuffer->GetIndexCount()), 1, 0, 0, 1);
 
 
@@ -207,7 +207,7 @@ void App::BuildDrawCommandBuffers()
 		vkCmdBindPipeline(m_DrawCommandBuffers["Color"][i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pRenderPipelines["Color"]->GetPipeline());
 		VkDeviceSize offsets[1] = { 0 };
 		vkCmdBindVertexBuffers(m_DrawCommandBuffers["Color"][i], 0, 1, &m_pVertexBuffers["Color"]->GetBuffer().GetHandle(), offsets);
-		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Color"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Color"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, m_pIndexBuffer->GetIndexType());
 		vkCmdDrawIndexed(m_DrawCommandBuffers["Color"][i], uint32_t(m_pIndexBuffer->GetIndexCount()), 1, 0, 0, 1);
 
 
@@ -235,7 +235,7 @@ void App::BuildDrawCommandBuffers()
 		vkCmdBindPipeline(m_DrawCommandBuffers["UV"][i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pRenderPipelines["UV"]->GetPipeline());
 		VkDeviceSize offsets[1] = { 0 };
 		vkCmdBindVertexBuffers(m_DrawCommandBuffers["UV"][i], 0, 1, &m_pVertexBuffers["UV"]->GetBuffer().GetHandle(), offsets);
-		vkCmdBindIndexBuffer(m_DrawCommandBuffers["UV"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(m_DrawCommandBuffers["UV"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, m_pIndexBuffer->GetIndexType());
 		vkCmdDrawIndexed(m_DrawCommandBuffers["UV"][i], uint32_t(m_pIndexBuffer->GetIndexCount()), 1, 0, 0, 1);
 
 
@@ -263,7 +263,7 @@ void App::BuildDrawCommandBuffers()
 		vkCmdBindPipeline(m_DrawCommandBuffers["Normal"][i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pRenderPipelines["Normal"]->GetPipeline());
 		VkDeviceSize offsets[1] = { 0 };
 		vkCmdBindVertexBuffers(m_DrawCommandBuffers["Normal"][i], 0, 1, &m_pVertexBuffers["Normal"]->GetBuffer().GetHandle(), offsets);
-		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Normal"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Normal"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, m_pIndexBuffer->GetIndexType());
 		vkCmdDrawIndexed(m_DrawCommandBuffers["Normal"][i], uint32_t(m_pIndexBuffer->GetIndexCount()), 1, 0, 0, 1);
 
 
@@ -292,7 +292,7 @@ void App::BuildDrawCommandBuffers()
 		vkCmdBindPipeline(m_DrawCommandBuffers["Diffuse"][i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pRenderPipelines["Diffuse"]->GetPipeline());
 		VkDeviceSize offsets[1] = { 0 };
 		vkCmdBindVertexBuffers(m_DrawCommandBuffers["Diffuse"][i], 0, 1, &m_pVertexBuffers["Diffuse"]->GetBuffer().GetHandle(), offsets);
-		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Diffuse"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(m_DrawCommandBuffers["Diffuse"][i], m_pIndexBuffer->GetBuffer().GetHandle(), 0, m_pIndexBuffer->GetIndexType());
 		vkCmdDrawIndexed(m_DrawCommandBuffers["Diffuse"][i], uint32_t(m_pIndexBuffer->GetIndexCount()), 1, 0, 0, 1);
 
 
@@ -325,7 +325,7 @@ void App::InitRenderModes()
 	m_VertexAttributes["Normal"] = { VertexAttribute::POSITION, VertexAttribute::NORMAL };
 	m_VertexAttributes["Diffuse"] = { VertexAttribute::POSITION, VertexAttribute::COLOR, VertexAttribute::NORMAL };
 
-	m_pIndexBuffer = new vkw::IndexBuffer(GetDevice(), GetCommandPool(), m_pPlaneMesh->GetIndices().size(), m_pPlaneMesh->GetIndices().data());
+	m_pIndexBuffer = new vkw::IndexBuffer(GetDevice(), GetCommandPool(), m_pPlaneMesh->GetIndices().size(), m_pPlaneMesh->GetIndices().data(), m_pPlaneMesh->GetVertexCount(m_VertexAttributes["Color"]));
 	glm::mat4x4 transMatrix = glm::translate(glm::mat4x4(1.f), { 0, 0, 0 });
 	glm::mat4x4 rotMatrix = glm::rotate(glm::mat4x4(1.f), -glm::pi<float>() / 4.f, { 0, 1, 0 });
 	m_pVertexBuffers["Color"] = new vkw::VertexBuffer(GetDevice(), GetCommandPool(),
@@ -0,0 +1,120 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <cassert>
+
+//Keeps the cave noise from repeating the surface noise.
+const uint32_t CaveSeedOffset = 0x68e31da4;
+
+TerrainGenerator::TerrainGenerator(const TerrainSettings& settings)
+	:m_Settings{ settings }
+	,m_MinSurfaceHeight{ settings.SurfaceHeight - settings.SurfaceAmplitude }
+	,m_MaxSurfaceHeight{ settings.SurfaceHeight + settings.SurfaceAmplitude }
+	,m_SurfaceScale{ 1.f / settings.SurfaceNoise.GetMaxAmplitude() }
+{
+	assert(settings.SurfaceAmplitude >= 0.f && settings.DirtDepth >= settings.GrassDepth && "Invalid terrain settings!");
+}
+
+bool TerrainGenerator::Generate(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels) const
+{
+	return Generate(chunkCoord, voxels, GetSupportedSimdLevel());
+}
+
+bool TerrainGenerator::Generate(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels, SimdLevel level) const
+{
+	assert(voxels.GetWidth() == voxels.GetHeight() && voxels.GetWidth() == voxels.GetDepth() && "Chunks have to be cubic!");
+	const int size = int(voxels.GetWidth());
+	const glm::ivec3 chunkPosition = chunkCoord * size;
+	const float bottom = float(chunkPosition.y);
+	const float top = float(chunkPosition.y + size - 1);
+
+	//Voxels are solid below the surface, so these bounds hold for every column the noise could produce.
+	if (bottom >= m_MaxSurfaceHeight)
+	{
+		voxels.Fill(0);
+		return true;
+	}
+	if (top < m_Settings.CaveBottom && m_MinSurfaceHeight - top > m_Settings.DirtDepth)
+	{
+		voxels.Fill(m_Settings.StoneValue);
+		return true;
+	}
+
+	const size_t columnCount = size_t(size) * size;
+	std::vector<float> columnX(columnCount);
+	std::vector<float> columnY(columnCount, 0.f);
+	std::vector<float> columnZ(columnCount);
+	std::vector<float> heights(columnCount);
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			columnX[x * size + z] = float(chunkPosition.x + x);
+			columnZ[x * size + z] = float(chunkPosition.z + z);
+		}
+	}
+	FractalNoise(columnX.data(), columnY.data(), columnZ.data(), columnCount, m_Settings.Seed, m_Settings.SurfaceNoise, heights.data(), level);
+	float maxHeight = m_MinSurfaceHeight;
+	for (float& height : heights)
+	{
+		height = m_Settings.SurfaceHeight + m_Settings.SurfaceAmplitude * std::min(std::max(height * m_SurfaceScale, -1.f), 1.f);
+		maxHeight = std::max(maxHeight, height);
+	}
+	if (bottom >= maxHeight)
+	{
+		voxels.Fill(0);
+		return true;
+	}
+
+	//Layers first, then the parts of the columns deep enough for caves are gathered so the cave noise runs over all of them in one batch.
+	uint32_t* pVoxels = voxels.Data();
+	std::vector<float> caveX;
+	std::vector<float> caveY;
+	std::vector<float> caveZ;
+	std::vector<uint32_t> caveVoxels;
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			const float height = heights[x * size + z];
+			for (int y = 0; y < size; y++)
+			{
+				const float worldY = bottom + float(y);
+				const size_t index = (size_t(x) * size + y) * size + z;
+				pVoxels[index] = worldY < height ? GetLayerValue(height - worldY) : 0;
+				if (worldY >= m_Settings.CaveBottom && height - worldY > m_Settings.CaveRoof)
+				{
+					caveX.push_back(columnX[x * size + z]);
+					caveY.push_back(worldY);
+					caveZ.push_back(columnZ[x * size + z]);
+					caveVoxels.push_back(uint32_t(index));
+				}
+			}
+		}
+	}
+	if (!caveVoxels.empty())
+	{
+		std::vector<float> caveNoise(caveVoxels.size());
+		FractalNoise(caveX.data(), caveY.data(), caveZ.data(), caveVoxels.size(), m_Settings.Seed + CaveSeedOffset, m_Settings.CaveNoise, caveNoise.data(), level);
+		for (size_t i = 0; i < caveVoxels.size(); i++)
+		{
+			if (caveNoise[i] > m_Settings.CaveThreshold)
+				pVoxels[caveVoxels[i]] = 0;
+		}
+	}
+	return std::all_of(pVoxels, pVoxels + voxels.GetSize(), [pVoxels](uint32_t value) { return value == pVoxels[0]; });
+}
+
+float TerrainGenerator::GetSurfaceHeight(float x, float z) const
+{
+	const float noise = FractalNoise({ x, 0.f, z }, m_Settings.Seed, m_Settings.SurfaceNoise);
+	return m_Settings.SurfaceHeight + m_Settings.SurfaceAmplitude * std::min(std::max(noise * m_SurfaceScale, -1.f), 1.f);
+}
+
+uint32_t TerrainGenerator::GetLayerValue(float depth) const
+{
+	if (depth <= m_Settings.GrassDepth)
+		return m_Settings.GrassValue;
+	if (depth <= m_Settings.DirtDepth)
+		return m_Settings.DirtValue;
+	return m_Settings.StoneValue;
+}
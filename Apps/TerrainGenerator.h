@@ -0,0 +1,48 @@
+#pragma once
+#include <Base/Array3D.h>
+#include <Base/Noise.h>
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <vector>
+
+struct TerrainSettings
+{
+	uint32_t		Seed{ 1 };
+	float			SurfaceHeight{ 24.f };		//Average height of the surface in voxels
+	float			SurfaceAmplitude{ 48.f };	//The surface never leaves SurfaceHeight +- SurfaceAmplitude
+	NoiseSettings	SurfaceNoise{ 1.f / 256.f, 5, 2.f, 0.5f };
+	NoiseSettings	CaveNoise{ 1.f / 48.f, 2, 2.f, 0.5f };
+	float			CaveThreshold{ 0.25f };		//Voxels with a larger cave noise are carved out
+	float			CaveBottom{ -96.f };		//No caves below this height
+	float			CaveRoof{ 6.f };			//Caves stay this many voxels below the surface
+	float			GrassDepth{ 1.f };
+	float			DirtDepth{ 4.f };
+	uint32_t		GrassValue{ 3 };
+	uint32_t		DirtValue{ 2 };
+	uint32_t		StoneValue{ 1 };
+};
+
+//Seeded terrain of a noise heightfield with caves carved out of it by 3D noise. Only reads its settings, so chunks can be generated
+//on any number of threads at once and a chunk always comes out the same, whichever thread generates it and in which order.
+class TerrainGenerator
+{
+public:
+	explicit TerrainGenerator(const TerrainSettings& settings = {});
+
+	//Fills the voxels of the chunk at chunkCoord. Chunks entirely above the highest possible surface or below the lowest one and the caves
+	//are filled without evaluating any noise, so are chunks the surface heights of their columns prove to be air. The cave noise is only
+	//evaluated for the part of a column that can hold caves, a whole column at once. Returns true when the chunk is one value.
+	bool Generate(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels) const;
+	bool Generate(const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels, SimdLevel level) const;
+	float GetSurfaceHeight(float x, float z) const;
+	const TerrainSettings& GetSettings() const { return m_Settings; }
+
+private:
+	//Value of a solid voxel depth voxels below the surface.
+	uint32_t GetLayerValue(float depth) const;
+
+	TerrainSettings	m_Settings{};
+	float			m_MinSurfaceHeight{};
+	float			m_MaxSurfaceHeight{};
+	float			m_SurfaceScale{};	//Maps the surface noise to [-1, 1]
+};
@@ -0,0 +1,1238 @@
+#include <Apps/VoxelChunk.h>
+#include <Apps/ChunkMesher.h>
+#include <Apps/ChunkStreamer.h>
+#include <Apps/ChunkStorage.h>
+#include <Apps/VoxelWorld.h>
+#include <Apps/TerrainGenerator.h>
+#include <Base/ThreadPool.h>
+#include <Base/RayPacket.h>
+#include <Base/Array3D.h>
+#include <Base/VertexTransform.h>
+#include <DataHandling/MeshShapes.h>
+#include <DataHandling/MappedFile.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+//Whole-cube mesher as it was before face culling, kept as reference for the meshing benchmark.
+void GenerateCubeMesh(Array3D<uint32_t>& voxelData, const glm::vec3& chunkPosition, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+	Mesh* cubeMesh = CreateCubeMesh(1.f, { 0.f,0.f }, { 0.3f, 0.6f, 0.f, 1.f });
+	const FloatVoxelLayout attributes{};
+	size_t cubeDataSize = cubeMesh->GetVertexDataSize(attributes) / sizeof(float);
+
+	const size_t size{ voxelData.GetDepth() };
+	vertices.clear();
+	vertices.resize(size * size * size * cubeDataSize);
+	float* writePos = vertices.data();
+	size_t vertexCount = 0;
+	size_t cubeCount = 0;
+	for (size_t y = 0; y < size; y++)
+	{
+		for (size_t z = 0; z < size; z++)
+		{
+			for (size_t x = 0; x < size; x++)
+			{
+				if (voxelData[x][y][z] == 0)
+					continue;
+				bool isBorder = x == 0 || y == 0 || z == 0 || x == size - 1 || y == size - 1 || z == size - 1;
+				if (!isBorder && voxelData[x + 1][y][z] != 0 && voxelData[x][y + 1][z] != 0 && voxelData[x][y][z + 1] != 0
+					&& voxelData[x - 1][y][z] != 0 && voxelData[x][y - 1][z] != 0 && voxelData[x][y][z - 1] != 0)
+					continue;
+
+				vertexCount += cubeDataSize;
+				cubeCount++;
+				glm::mat4x4 translation = glm::translate(glm::mat4x4(1.f), { x + chunkPosition.x + 0.5f, y + chunkPosition.y + 0.5f , z + chunkPosition.z + 0.5f });
+				writePos = cubeMesh->CreateVertices(attributes, writePos, translation);
+			}
+		}
+	}
+	vertices.resize(vertexCount);
+	//Every cube repeats the same indices, offset by the vertices of the cubes before it.
+	indices.resize(cubeMesh->GetIndexCount() * cubeCount);
+	cubeMesh->GetIndices(0, uint32_t(cubeMesh->GetVertexCount(attributes)), cubeCount, indices.data());
+	delete cubeMesh;
+}
+
+//Box stepping raycast as it was before the DDA, kept as reference for the raycast benchmark.
+bool LegacyRaycast(const VoxelChunk& chunk, glm::ivec3& voxelId, const Ray& ray, float minDist, float maxDist)
+{
+	const BrickMap& voxelData = chunk.GetData();
+	AABox box{ chunk.GetPosition(), {voxelData.GetWidth(), voxelData.GetHeight(), voxelData.GetHeight()} };
+	float tenter, texit;
+	float toffset = 0.0001f;
+	float t;
+	if (!chunk.IsInChunk(ray.Pos))
+	{
+		if (!ray.Intersect(box, tenter, texit))
+			return false;
+		else
+			t = tenter + toffset;
+	}else
+	{
+		t = 0;
+	}
+	if (t > maxDist)
+		return false;
+	if (t < minDist)
+		return false;
+	glm::vec3 pos = ray.Traverse(t);
+	if (!chunk.IsInChunk(pos))
+		return false;
+	glm::ivec3 currVoxel = chunk.GetVoxel(pos);
+	const int maxSteps = 100;
+	int steps = 0;
+	while (!chunk.GetOccupancy().IsSet(currVoxel))
+	{
+		if (steps++ >= maxSteps)
+			return false;
+		AABox voxelBounds{ glm::vec3(currVoxel) + chunk.GetPosition(), {1.f, 1.f, 1.f} };
+		if (ray.Intersect(voxelBounds, tenter, texit))
+		{
+			t = texit + toffset;
+			if (t > maxDist)
+				return false;
+			if (t < minDist)
+				return false;
+		}else
+		{
+			return false;
+		}
+		pos = ray.Traverse(t);
+		currVoxel = chunk.GetVoxel(pos);
+		if (!chunk.IsInChunk(pos))
+			return false;
+	}
+	voxelId = currVoxel;
+	return true;
+}
+
+Array3D<uint32_t> CreateSolidVolume(size_t size)
+{
+	Array3D<uint32_t> volume{ size, size, size };
+	for (size_t i = 0; i < size * size * size; i++)
+	{
+		volume.Data()[i] = 1;
+	}
+	return volume;
+}
+
+//Rolling heightfield, roughly what a terrain chunk looks like.
+Array3D<uint32_t> CreateTerrainVolume(size_t size)
+{
+	Array3D<uint32_t> volume{ size, size, size };
+	for (size_t x = 0; x < size; x++)
+	{
+		for (size_t z = 0; z < size; z++)
+		{
+			float height = size * (0.5f + 0.2f * sinf(x * 0.3f) * cosf(z * 0.2f));
+			for (size_t y = 0; y < size && y < height; y++)
+			{
+				volume[x][y][z] = 1;
+			}
+		}
+	}
+	return volume;
+}
+
+float MeasureMs(const std::function<void()>& function, int iterations)
+{
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		function();
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	return std::chrono::duration<float>(t2 - t1).count() * 1000 / iterations;
+}
+
+size_t GetMaxThreadCount()
+{
+	return glm::max(std::thread::hardware_concurrency(), 1u);
+}
+
+//Times function on pools of 1, 2, 4, ... threads up to one per core. print gets every thread count with its time and the time on one thread.
+void MeasureThreadScaling(const std::function<void(ThreadPool& threadPool)>& function, int iterations, const std::function<void(size_t threadCount, float ms, float singleThreadMs)>& print)
+{
+	float singleThreadMs = 0;
+	for (size_t threadCount = 1; threadCount <= GetMaxThreadCount(); threadCount *= 2)
+	{
+		ThreadPool threadPool{ threadCount };
+		const float ms = MeasureMs([&]() { function(threadPool); }, iterations);
+		if (threadCount == 1)
+			singleThreadMs = ms;
+		print(threadCount, ms, singleThreadMs);
+	}
+}
+
+//Scalar and every wider SIMD level the CPU supports.
+std::vector<SimdLevel> GetSupportedSimdLevels()
+{
+	std::vector<SimdLevel> levels;
+	for (int level = int(SimdLevel::Scalar); level <= int(GetSupportedSimdLevel()); level++)
+	{
+		levels.push_back(SimdLevel(level));
+	}
+	return levels;
+}
+
+void PrintResult(const std::string& name, size_t vertexCount, size_t indexCount, size_t memorySize, float ms)
+{
+	std::cout << "  " << std::left << std::setw(14) << name
+		<< std::right << std::setw(10) << vertexCount << " vertices"
+		<< std::setw(10) << indexCount / 3 << " triangles"
+		<< std::setw(10) << std::fixed << std::setprecision(2) << memorySize / (1024.f * 1024.f) << " MB"
+		<< std::setw(10) << std::setprecision(3) << ms << " ms" << std::endl;
+}
+
+void PrintResult(const std::string& name, const VoxelMesh& mesh, float ms)
+{
+	PrintResult(name, mesh.GetVertexCount(), mesh.GetIndexCount(), mesh.GetVertexDataSize() + mesh.Indices.size() * sizeof(uint32_t), ms);
+}
+
+void BenchmarkMeshing(const std::string& sceneName, Array3D<uint32_t> volume)
+{
+	const int size = int(volume.GetWidth());
+	const int iterations = size >= 64 ? 2 : 10;
+	std::cout << sceneName << " " << size << "^3" << std::endl;
+
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+	float cubeMs = MeasureMs([&]() { GenerateCubeMesh(volume, {}, vertices, indices); }, iterations);
+	PrintResult("Cubes", vertices.size() / 10, indices.size(), vertices.size() * sizeof(float) + indices.size() * sizeof(uint32_t), cubeMs);
+
+	VoxelChunk chunk{ volume };
+	float culledMs = MeasureMs([&]() { chunk.GenerateMesh(MeshingMode::CulledFaces); }, iterations);
+	PrintResult("Culled faces", chunk.GetVoxelMesh(), culledMs);
+	const size_t culledIndexCount = chunk.GetVoxelMesh().GetIndexCount();
+
+	float packedMs = MeasureMs([&]() { chunk.GenerateMesh(MeshingMode::CulledFaces, VoxelVertexFormat::Packed); }, iterations);
+	PrintResult("Culled packed", chunk.GetVoxelMesh(), packedMs);
+
+	float greedyMs = MeasureMs([&]() { chunk.GenerateMesh(MeshingMode::Greedy); }, iterations);
+	PrintResult("Greedy", chunk.GetVoxelMesh(), greedyMs);
+	const size_t greedyIndexCount = chunk.GetVoxelMesh().GetIndexCount();
+	std::cout << "  Greedy triangle reduction: " << std::setprecision(1)
+		<< float(indices.size()) / greedyIndexCount << "x vs cubes, "
+		<< float(culledIndexCount) / greedyIndexCount << "x vs culled faces" << std::endl;
+
+	//Toggle single voxels through the middle of the chunk and only remesh the sections they touch.
+	std::vector<size_t> updatedSections;
+	size_t updatedSectionCount = 0;
+	int editId = 0;
+	const int editCount = 100;
+	float editMs = MeasureMs([&]()
+	{
+		const glm::ivec3 voxelId{ (editId * 7) % size, size / 2, (editId * 13) % size };
+		editId++;
+		chunk.SetVoxelValue(voxelId, chunk.GetVoxelValue(voxelId) == 0 ? 1 : 0);
+		chunk.MarkDirty(voxelId);
+		updatedSections.clear();
+		chunk.UpdateDirtySections(updatedSections);
+		updatedSectionCount += updatedSections.size();
+	}, editCount);
+	PrintResult("Greedy edit", chunk.GetVoxelMesh(), editMs);
+	std::cout << "  Single voxel edit: " << std::setprecision(1) << float(updatedSectionCount) / editCount << " sections remeshed, "
+		<< greedyMs / editMs << "x faster than a full remesh" << std::endl;
+}
+
+//Rays from random points above the terrain towards random points inside the chunk.
+std::vector<Ray> CreateRandomRays(size_t rayCount, float chunkSize)
+{
+	std::default_random_engine rndEngine(42);
+	std::uniform_real_distribution<float> rnd(0.f, chunkSize);
+	std::vector<Ray> rays(rayCount);
+	for (Ray& ray : rays)
+	{
+		ray.Pos = { rnd(rndEngine), chunkSize + rnd(rndEngine), rnd(rndEngine) };
+		ray.Dir = glm::normalize(glm::vec3{ rnd(rndEngine), rnd(rndEngine), rnd(rndEngine) } - ray.Pos);
+	}
+	return rays;
+}
+
+void BenchmarkRaycast(size_t size)
+{
+	std::cout << "Raycast terrain " << size << "^3" << std::endl;
+	VoxelChunk chunk{ CreateTerrainVolume(size) };
+	const std::vector<Ray> rays = CreateRandomRays(100000, float(size));
+
+	size_t legacyHitCount = 0;
+	float legacyMs = MeasureMs([&]()
+	{
+		legacyHitCount = 0;
+		glm::ivec3 voxelId;
+		for (const Ray& ray : rays)
+		{
+			legacyHitCount += LegacyRaycast(chunk, voxelId, ray, 0, FLT_MAX);
+		}
+	}, 2);
+
+	size_t hitCount = 0;
+	float ddaMs = MeasureMs([&]()
+	{
+		hitCount = 0;
+		VoxelHit hit;
+		for (const Ray& ray : rays)
+		{
+			hitCount += chunk.Raycast(hit, ray);
+		}
+	}, 2);
+
+	//Box stepping misses some rays that only graze the edge of a voxel, so the counts only agree within a few percent.
+	const bool isMatching = std::abs(double(hitCount) - double(legacyHitCount)) <= 0.02 * double(legacyHitCount);
+	std::cout << "  " << std::left << std::setw(14) << "Box stepping" << std::right << std::setw(10) << legacyHitCount << " hits"
+		<< std::setw(10) << std::fixed << std::setprecision(2) << rays.size() / (legacyMs * 1000) << " Mrays/s" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "DDA" << std::right << std::setw(10) << hitCount << " hits"
+		<< std::setw(10) << std::fixed << std::setprecision(2) << rays.size() / (ddaMs * 1000) << " Mrays/s"
+		<< std::setw(8) << std::setprecision(1) << legacyMs / ddaMs << "x" << (isMatching ? "" : "  MISMATCH") << std::endl;
+}
+
+//Rolling heightfield over a whole world with grass, dirt and stone layers, the chunks above the terrain stay empty.
+void FillTerrainWorld(VoxelWorld& world)
+{
+	const int chunkSize = world.GetChunkSize();
+	for (size_t i = 0; i < world.GetChunkCount(); i++)
+	{
+		VoxelChunk* pChunk = world.GetChunk(i);
+		const glm::ivec3 chunkPosition = glm::ivec3(pChunk->GetPosition());
+		Array3D<uint32_t> volume{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+		for (int x = 0; x < chunkSize; x++)
+		{
+			for (int z = 0; z < chunkSize; z++)
+			{
+				const float height = chunkSize * (1.5f + 0.5f * sinf((chunkPosition.x + x) * 0.05f) * cosf((chunkPosition.z + z) * 0.04f));
+				for (int y = 0; y < chunkSize && chunkPosition.y + y < height; y++)
+				{
+					const float depth = height - (chunkPosition.y + y);
+					volume[x][y][z] = depth <= 1.f ? 3 : (depth <= 4.f ? 2 : 1);
+				}
+			}
+		}
+		world.SetChunkData(i, BrickMap{ volume });
+	}
+}
+
+void BenchmarkWorldRaycast(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "World raycast " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	VoxelWorld world{ chunkCount, chunkSize };
+	FillTerrainWorld(world);
+
+	//Rays from above the terrain looking down at a random spot in the world.
+	const glm::vec3 worldSize = glm::vec3(chunkCount * chunkSize);
+	std::default_random_engine rndEngine(7);
+	std::uniform_real_distribution<float> rnd(0.f, 1.f);
+	std::vector<Ray> rays(20000);
+	for (Ray& ray : rays)
+	{
+		ray.Pos = glm::vec3{ rnd(rndEngine), 0.9f + 0.1f * rnd(rndEngine), rnd(rndEngine) } * worldSize;
+		ray.Dir = glm::normalize(glm::vec3{ rnd(rndEngine), 0.2f * rnd(rndEngine), rnd(rndEngine) } * worldSize - ray.Pos);
+	}
+
+	//What VulkanApp used to do: try every chunk and keep the first one that reports a hit.
+	size_t loopHitCount = 0;
+	std::vector<float> loopDistances(rays.size());
+	float loopMs = MeasureMs([&]()
+	{
+		loopHitCount = 0;
+		VoxelHit hit;
+		for (size_t r = 0; r < rays.size(); r++)
+		{
+			loopDistances[r] = FLT_MAX;
+			for (size_t i = 0; i < world.GetChunkCount(); i++)
+			{
+				if (world.GetChunk(i)->Raycast(hit, rays[r]))
+				{
+					loopDistances[r] = hit.Distance;
+					loopHitCount++;
+					break;
+				}
+			}
+		}
+	}, 1);
+
+	size_t hitCount = 0;
+	size_t nearerCount = 0;
+	float worldMs = MeasureMs([&]()
+	{
+		hitCount = 0;
+		nearerCount = 0;
+		VoxelHit hit;
+		size_t chunkId;
+		for (size_t r = 0; r < rays.size(); r++)
+		{
+			if (world.Raycast(hit, chunkId, rays[r]))
+			{
+				hitCount++;
+				nearerCount += hit.Distance < loopDistances[r];
+			}
+		}
+	}, 1);
+
+	std::cout << "  " << std::left << std::setw(14) << "Chunk loop" << std::right << std::setw(10) << loopHitCount << " hits"
+		<< std::setw(10) << std::fixed << std::setprecision(2) << rays.size() / (loopMs * 1000) << " Mrays/s" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "Grid DDA" << std::right << std::setw(10) << hitCount << " hits"
+		<< std::setw(10) << std::fixed << std::setprecision(2) << rays.size() / (worldMs * 1000) << " Mrays/s"
+		<< std::setw(8) << std::setprecision(1) << loopMs / worldMs << "x, " << nearerCount << " hits nearer than the chunk loop" << std::endl;
+}
+
+//Traces one batch of rays through a world with an increasing amount of workers.
+void BenchmarkBatchRaycast(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Batch raycast " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	VoxelWorld world{ chunkCount, chunkSize };
+	FillTerrainWorld(world);
+
+	const glm::vec3 worldSize = glm::vec3(chunkCount * chunkSize);
+	std::default_random_engine rndEngine(11);
+	std::uniform_real_distribution<float> rnd(0.f, 1.f);
+	const size_t rayCount = 100000;
+	std::vector<Ray> rays(rayCount);
+	std::vector<float> maxDistances(rayCount);
+	for (size_t i = 0; i < rayCount; i++)
+	{
+		rays[i].Pos = glm::vec3{ rnd(rndEngine), 0.5f + 0.5f * rnd(rndEngine), rnd(rndEngine) } * worldSize;
+		rays[i].Dir = glm::normalize(glm::vec3{ rnd(rndEngine), rnd(rndEngine), rnd(rndEngine) } * worldSize - rays[i].Pos);
+		maxDistances[i] = 64.f + 64.f * rnd(rndEngine);
+	}
+	std::vector<VoxelRayResult> results(rayCount);
+
+	MeasureThreadScaling([&](ThreadPool& threadPool) { world.RaycastBatch(threadPool, rays.data(), maxDistances.data(), rayCount, results.data()); }, 2,
+		[&](size_t threadCount, float ms, float singleThreadMs)
+	{
+		size_t hitCount = 0;
+		for (const VoxelRayResult& result : results)
+		{
+			hitCount += result.IsHit;
+		}
+		std::cout << "  " << std::left << std::setw(14) << (std::to_string(threadCount) + " threads")
+			<< std::right << std::setw(10) << hitCount << " hits"
+			<< std::setw(10) << std::fixed << std::setprecision(2) << rayCount / (ms * 1000) << " Mrays/s"
+			<< std::setw(8) << std::setprecision(2) << singleThreadMs / ms << "x" << std::endl;
+	});
+}
+
+//A speedup only counts when the kernel finds the same hits as the reference.
+void PrintBoxTestResult(const std::string& name, size_t hitCount, size_t referenceHitCount, size_t testCount, float ms, float referenceMs)
+{
+	assert(hitCount == referenceHitCount && "Ray-box kernel disagrees with Ray::Intersect!");
+	std::cout << "  " << std::left << std::setw(14) << name << std::right << std::setw(10) << hitCount << " hits"
+		<< std::setw(10) << std::fixed << std::setprecision(1) << testCount / (ms * 1000) << " Mtests/s"
+		<< std::setw(8) << std::setprecision(1) << referenceMs / ms << "x" << (hitCount == referenceHitCount ? "" : "  MISMATCH") << std::endl;
+}
+
+//One ray against many boxes and many rays against one box, the way chunk culling and picking test the chunk bounds.
+void BenchmarkRayBoxes(size_t boxCount, size_t rayCount)
+{
+	std::cout << "Ray-box tests, " << rayCount << " rays x " << boxCount << " boxes, widest kernel " << GetSimdLevelName(GetSupportedSimdLevel()) << std::endl;
+	std::default_random_engine rndEngine(3);
+	std::uniform_real_distribution<float> rnd(-1.f, 1.f);
+	std::vector<AABox> boxes(boxCount);
+	AABoxSoA boxesSoA;
+	for (AABox& box : boxes)
+	{
+		box.Position = glm::vec3{ rnd(rndEngine), rnd(rndEngine), rnd(rndEngine) } * 100.f;
+		box.Extent = glm::vec3{ 16.f };
+		boxesSoA.Add(box);
+	}
+	std::vector<Ray> rays(rayCount);
+	InvRaySoA raysSoA;
+	for (Ray& ray : rays)
+	{
+		ray.Pos = glm::vec3{ rnd(rndEngine), rnd(rndEngine), rnd(rndEngine) } * 100.f;
+		ray.Dir = glm::normalize(glm::vec3{ rnd(rndEngine), rnd(rndEngine), rnd(rndEngine) });
+		raysSoA.Add(InvRay{ ray });
+	}
+
+	const size_t testCount = boxCount * rayCount;
+	std::vector<uint8_t> hits(std::max(boxCount, rayCount));
+	std::vector<float> enterDistances(hits.size());
+	size_t hitCount = 0;
+	float referenceMs = MeasureMs([&]()
+	{
+		hitCount = 0;
+		float tenter, texit;
+		for (const Ray& ray : rays)
+		{
+			for (const AABox& box : boxes)
+			{
+				hitCount += ray.Intersect(box, tenter, texit) && texit >= 0;
+			}
+		}
+	}, 1);
+	const size_t referenceHitCount = hitCount;
+	PrintBoxTestResult("Ray::Intersect", hitCount, referenceHitCount, testCount, referenceMs, referenceMs);
+
+	float invRayMs = MeasureMs([&]()
+	{
+		hitCount = 0;
+		float tenter, texit;
+		for (const Ray& ray : rays)
+		{
+			const InvRay invRay{ ray };
+			for (const AABox& box : boxes)
+			{
+				hitCount += invRay.Intersect(box, tenter, texit);
+			}
+		}
+	}, 1);
+	PrintBoxTestResult("InvRay", hitCount, referenceHitCount, testCount, invRayMs, referenceMs);
+
+	const std::vector<SimdLevel> levels = GetSupportedSimdLevels();
+	for (SimdLevel level : levels)
+	{
+		float ms = MeasureMs([&]()
+		{
+			hitCount = 0;
+			for (const Ray& ray : rays)
+			{
+				IntersectBoxes(InvRay{ ray }, boxesSoA, 0, FLT_MAX, hits.data(), enterDistances.data(), level);
+				for (size_t i = 0; i < boxCount; i++)
+				{
+					hitCount += hits[i];
+				}
+			}
+		}, 1);
+		PrintBoxTestResult(std::string("1xN ") + GetSimdLevelName(level), hitCount, referenceHitCount, testCount, ms, referenceMs);
+	}
+	for (SimdLevel level : levels)
+	{
+		float ms = MeasureMs([&]()
+		{
+			hitCount = 0;
+			for (const AABox& box : boxes)
+			{
+				IntersectRays(raysSoA, box, 0, FLT_MAX, hits.data(), enterDistances.data(), level);
+				for (size_t i = 0; i < rayCount; i++)
+				{
+					hitCount += hits[i];
+				}
+			}
+		}, 1);
+		PrintBoxTestResult(std::string("Nx1 ") + GetSimdLevelName(level), hitCount, referenceHitCount, testCount, ms, referenceMs);
+	}
+}
+
+//Meshes a grid of chunks with an increasing amount of workers.
+void BenchmarkParallelMeshing(size_t gridSize, size_t chunkSize)
+{
+	std::cout << "Parallel meshing " << gridSize << "^3 chunks of " << chunkSize << "^3" << std::endl;
+	Array3D<uint32_t> volume = CreateTerrainVolume(chunkSize);
+	std::vector<VoxelChunk*> pChunks;
+	for (size_t i = 0; i < gridSize * gridSize * gridSize; i++)
+	{
+		pChunks.push_back(new VoxelChunk{ volume });
+	}
+
+	std::vector<ChunkMeshResult> results;
+	MeasureThreadScaling([&](ThreadPool& threadPool)
+	{
+		ChunkMesher chunkMesher{ &threadPool };
+		for (size_t i = 0; i < pChunks.size(); i++)
+		{
+			chunkMesher.Submit(i, *pChunks[i], MeshingMode::Greedy, VoxelVertexFormat::Float);
+		}
+		chunkMesher.Wait();
+		results.clear();
+		chunkMesher.PopResults(results);
+	}, 2, [&](size_t threadCount, float ms, float singleThreadMs)
+	{
+		std::cout << "  " << std::left << std::setw(14) << (std::to_string(threadCount) + " threads")
+			<< std::right << std::setw(10) << results.size() << " chunks"
+			<< std::setw(10) << std::fixed << std::setprecision(1) << pChunks.size() / (ms / 1000) << " chunks/s"
+			<< std::setw(10) << std::setprecision(3) << ms << " ms"
+			<< std::setw(8) << std::setprecision(2) << singleThreadMs / ms << "x" << std::endl;
+	});
+
+	for (VoxelChunk* pChunk : pChunks)
+	{
+		delete pChunk;
+	}
+}
+
+//Memory of the sparse brick storage against a dense array, and the cost of reading every voxel through it.
+void BenchmarkStorage(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Voxel storage " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	VoxelWorld world{ chunkCount, chunkSize };
+	const float fillMs = MeasureMs([&]() { FillTerrainWorld(world); }, 1);
+
+	const size_t chunkVoxelCount = size_t(chunkSize) * chunkSize * chunkSize;
+	const size_t denseSize = world.GetChunkCount() * chunkVoxelCount * sizeof(uint32_t);
+	size_t brickSize = 0;
+	size_t sharedSize = 0;
+	std::unordered_set<const VoxelChunkData*> sharedData{};
+	size_t denseBrickCount = 0;
+	size_t brickCount = 0;
+	size_t indexBits = 0;
+	for (size_t i = 0; i < world.GetChunkCount(); i++)
+	{
+		const VoxelChunkData* pData = world.GetChunk(i)->GetSharedData().get();
+		if (sharedData.insert(pData).second)
+			sharedSize += pData->GetMemorySize();
+		const BrickMap& data = pData->Voxels;
+		brickSize += pData->GetMemorySize();
+		denseBrickCount += data.GetDenseBrickCount();
+		indexBits += data.GetIndexBits();
+		const glm::ivec3 chunkBricks = data.GetBrickCount();
+		brickCount += size_t(chunkBricks.x) * chunkBricks.y * chunkBricks.z;
+	}
+	std::cout << "  " << std::left << std::setw(14) << "Dense" << std::right << std::setw(10) << std::fixed << std::setprecision(2) << denseSize / (1024.f * 1024.f) << " MB" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "Bricks" << std::right << std::setw(10) << brickSize / (1024.f * 1024.f) << " MB"
+		<< std::setw(8) << std::setprecision(1) << float(denseSize) / brickSize << "x smaller, "
+		<< denseBrickCount << "/" << brickCount << " bricks dense, " << float(indexBits) / world.GetChunkCount() << " bits per index" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "Shared" << std::right << std::setw(10) << std::setprecision(2) << sharedSize / (1024.f * 1024.f) << " MB"
+		<< std::setw(8) << std::setprecision(1) << float(denseSize) / sharedSize << "x smaller, "
+		<< sharedData.size() << "/" << world.GetChunkCount() << " chunks unique, filled in " << std::setprecision(1) << fillMs << " ms" << std::endl;
+
+	const BrickMap& bricks = world.GetChunk(0)->GetData();
+	Array3D<uint32_t> dense{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+	bricks.CopyTo(dense);
+	uint64_t denseSum = 0;
+	float denseMs = MeasureMs([&]()
+	{
+		for (int x = 0; x < chunkSize; x++)
+		{
+			for (int y = 0; y < chunkSize; y++)
+			{
+				for (int z = 0; z < chunkSize; z++)
+				{
+					denseSum += dense.at(x, y, z);
+				}
+			}
+		}
+	}, 100);
+	uint64_t brickSum = 0;
+	float brickMs = MeasureMs([&]()
+	{
+		for (int x = 0; x < chunkSize; x++)
+		{
+			for (int y = 0; y < chunkSize; y++)
+			{
+				for (int z = 0; z < chunkSize; z++)
+				{
+					brickSum += bricks.Get(x, y, z);
+				}
+			}
+		}
+	}, 100);
+	assert(denseSum == brickSum);
+	std::cout << "  Voxel reads: dense " << std::setprecision(1) << chunkVoxelCount / (denseMs * 1000) << " Mvoxels/s, bricks "
+		<< chunkVoxelCount / (brickMs * 1000) << " Mvoxels/s" << std::endl;
+}
+
+//Cost of the bulk Array3D operations chunk creation and streaming are built from.
+void BenchmarkArrayOps(size_t size)
+{
+	std::cout << "Array3D operations " << size << "^3" << std::endl;
+	const size_t voxelCount = size * size * size;
+	auto printRow = [](const std::string& name, float ms, const std::string& note)
+	{
+		std::cout << "  " << std::left << std::setw(20) << name << std::right << std::setw(10) << std::fixed << std::setprecision(3) << ms << " ms  " << note << std::endl;
+	};
+
+	//Read back a value so the optimizer can not drop the work on arrays that are destroyed right away.
+	volatile uint32_t sink = 0;
+	const float allocateMs = MeasureMs([&]() { Array3D<uint32_t> volume{ size, size, size }; sink = volume.Data()[voxelCount / 2]; }, 10);
+	printRow("Allocate zeroed", allocateMs, "");
+	Array3D<uint32_t> volume{ size, size, size };
+	const float fillMs = MeasureMs([&]() { volume.Fill(1); }, 10);
+	printRow("Fill", fillMs, "");
+	const float copyMs = MeasureMs([&]() { Array3D<uint32_t> copy{ volume }; sink = copy.Data()[voxelCount / 2]; }, 10);
+	printRow("Copy", copyMs, "");
+	const float moveMs = MeasureMs([&]()
+	{
+		Array3D<uint32_t> moved{ std::move(volume) };
+		volume = std::move(moved);
+	}, 10);
+	printRow("Move", moveMs, "there and back, no voxels copied");
+	Array3D<uint32_t> region{ size / 2, size / 2, size / 2 };
+	const float regionMs = MeasureMs([&]() { region.CopyRegion(volume, size / 4, size / 4, size / 4, 0, 0, 0, size / 2, size / 2, size / 2); }, 10);
+	printRow("CopyRegion 1/8", regionMs, "");
+
+	//Some work per voxel so the threads have something to split.
+	auto generate = [](size_t x, size_t y, size_t z, uint32_t& value) { value = float(y) < 32.f + 8.f * sinf(x * 0.1f) * cosf(z * 0.1f) ? 1 : 0; };
+	const float forEachMs = MeasureMs([&]() { volume.ForEach(generate); }, 4);
+	ThreadPool threadPool{};
+	const float parallelMs = MeasureMs([&]() { volume.ForEachParallel(threadPool, generate); }, 4);
+	std::ostringstream note;
+	note << std::setprecision(1) << std::fixed << voxelCount / (forEachMs * 1000) << " Mvoxels/s";
+	printRow("ForEach", forEachMs, note.str());
+	note.str("");
+	note << voxelCount / (parallelMs * 1000) << " Mvoxels/s on " << threadPool.GetThreadCount() << " threads, " << forEachMs / parallelMs << "x";
+	printRow("ForEachParallel", parallelMs, note.str());
+}
+
+//Flies a camera over an endless terrain at a fixed speed and times the main thread side of streaming every frame: removing, adding
+//and meshing submissions plus popping the finished meshes, the way VulkanApp drives it.
+void BenchmarkStreaming(int chunkSize, int loadRadius, float chunksPerSecond)
+{
+	std::cout << "Streaming chunks of " << chunkSize << "^3, load radius " << loadRadius << ", camera at " << chunksPerSecond << " chunks/s" << std::endl;
+	auto generate = [](const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels)
+	{
+		const glm::ivec3 chunkPosition = chunkCoord * int(voxels.GetWidth());
+		for (int x = 0; x < int(voxels.GetWidth()); x++)
+		{
+			for (int z = 0; z < int(voxels.GetDepth()); z++)
+			{
+				const float height = 24.f + 8.f * sinf((chunkPosition.x + x) * 0.05f) * cosf((chunkPosition.z + z) * 0.04f);
+				for (int y = 0; y < int(voxels.GetHeight()) && chunkPosition.y + y < height; y++)
+				{
+					voxels[x][y][z] = 1;
+				}
+			}
+		}
+	};
+	VoxelWorld world{ chunkSize };
+	ThreadPool threadPool{};
+	ChunkMesher mesher{ &threadPool };
+	ChunkStreamingSettings settings{};
+	settings.LoadRadius = loadRadius;
+	settings.UnloadRadius = loadRadius + 2;
+	ChunkStreamer streamer{ &world, &threadPool, generate, settings };
+
+	const float frameTime = 1.f / 60.f;
+	const int frameCount = 600;
+	std::vector<size_t> addedChunks;
+	std::vector<size_t> removedChunks;
+	std::vector<ChunkMeshResult> meshes;
+	std::vector<float> frameMs;
+	size_t addedCount = 0;
+	size_t removedCount = 0;
+	int filledFrame = -1;
+	glm::vec3 cameraPosition{ 0.f, 40.f, 0.f };
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		addedChunks.clear();
+		removedChunks.clear();
+		streamer.Update(cameraPosition, { 1.f, 0.f, 0.f }, addedChunks, removedChunks);
+		for (size_t chunkId : removedChunks)
+		{
+			mesher.Cancel(chunkId);
+		}
+		for (size_t chunkId : addedChunks)
+		{
+			mesher.Submit(chunkId, *world.GetChunk(chunkId), MeshingMode::Greedy, VoxelVertexFormat::Packed);
+		}
+		meshes.clear();
+		mesher.PopResults(meshes, 8);
+		for (ChunkMeshResult& mesh : meshes)
+		{
+			world.GetChunk(mesh.ChunkId)->SetVoxelMesh(std::move(mesh.Mesh));
+		}
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+		frameMs.push_back(std::chrono::duration<float>(t2 - t1).count() * 1000);
+		addedCount += addedChunks.size();
+		removedCount += removedChunks.size();
+		if (filledFrame < 0 && streamer.GetMissingCount() == 0 && streamer.GetGeneratingCount() == 0)
+			filledFrame = frame;
+		//Hold still until the radius is filled once, then fly.
+		if (filledFrame >= 0)
+			cameraPosition.x += chunksPerSecond * chunkSize * frameTime;
+		//Pace the frames so the workers get the same time they would get while rendering.
+		std::this_thread::sleep_until(t1 + std::chrono::microseconds(int(frameTime * 1e6f)));
+	}
+	threadPool.Wait();
+
+	std::sort(frameMs.begin(), frameMs.end());
+	float totalMs = 0.f;
+	for (float ms : frameMs)
+	{
+		totalMs += ms;
+	}
+	std::cout << "  " << std::left << std::setw(20) << "Main thread per frame" << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(8) << totalMs / frameMs.size() << " ms avg" << std::setw(8) << frameMs[frameMs.size() * 99 / 100] << " ms p99"
+		<< std::setw(8) << frameMs.back() << " ms worst" << std::endl;
+	std::cout << "  " << std::left << std::setw(20) << "Chunks" << std::right << std::setw(8) << world.GetResidentChunkCount() << " resident"
+		<< std::setw(8) << addedCount << " added" << std::setw(8) << removedCount << " removed, radius filled after "
+		<< std::setprecision(2) << filledFrame * frameTime << " s" << std::endl;
+}
+
+//Saves a terrain world to region files on the background writer and loads every chunk back through the memory mapped files.
+void BenchmarkRegionFiles(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Region files " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	VoxelWorld world{ chunkCount, chunkSize };
+	FillTerrainWorld(world);
+	const std::string pathPrefix = "BenchmarkRegion_";
+	std::unordered_set<std::string> filenames;
+	size_t fileSize = 0;
+	float queueMs = 0.f;
+	float saveMs = 0.f;
+	{
+		ChunkStorage storage{ pathPrefix, chunkSize };
+		saveMs = MeasureMs([&]()
+		{
+			queueMs = MeasureMs([&]()
+			{
+				for (size_t i = 0; i < world.GetChunkCount(); i++)
+				{
+					storage.SaveChunk(world.GetChunkCoord(i), world.GetChunk(i)->GetSharedData());
+				}
+			}, 1);
+			storage.Flush();
+		}, 1);
+		for (size_t i = 0; i < world.GetChunkCount(); i++)
+		{
+			filenames.insert(storage.GetRegionFilename(ChunkStorage::GetRegionCoord(world.GetChunkCoord(i))));
+		}
+		for (const std::string& filename : filenames)
+		{
+			MappedFile file;
+			if (file.Open(filename))
+				fileSize += file.GetSize();
+		}
+	}
+
+	//A new storage maps the files from scratch, so the first pass includes opening and page faults.
+	ChunkStorage storage{ pathPrefix, chunkSize };
+	Array3D<uint32_t> voxels{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+	Array3D<uint32_t> expected{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+	size_t loadedCount = 0;
+	auto loadChunks = [&]()
+	{
+		loadedCount = 0;
+		for (size_t i = 0; i < world.GetChunkCount(); i++)
+		{
+			loadedCount += storage.LoadChunk(world.GetChunkCoord(i), voxels);
+		}
+	};
+	const float coldMs = MeasureMs(loadChunks, 1);
+	const float warmMs = MeasureMs(loadChunks, 4);
+	bool isEqual = loadedCount == world.GetChunkCount();
+	for (size_t i = 0; i < world.GetChunkCount() && isEqual; i++)
+	{
+		storage.LoadChunk(world.GetChunkCoord(i), voxels);
+		world.GetChunk(i)->GetData().CopyTo(expected);
+		isEqual = std::equal(voxels.Data(), voxels.Data() + voxels.GetSize(), expected.Data());
+	}
+	for (const std::string& filename : filenames)
+	{
+		std::remove(filename.c_str());
+	}
+
+	const size_t denseSize = world.GetChunkCount() * voxels.GetSize() * sizeof(uint32_t);
+	std::cout << "  " << std::left << std::setw(12) << "Files" << std::right << std::setw(10) << std::fixed << std::setprecision(2) << fileSize / (1024.f * 1024.f) << " MB in "
+		<< filenames.size() << " regions, " << std::setprecision(1) << float(denseSize) / fileSize << "x smaller than dense" << std::endl;
+	std::cout << "  " << std::left << std::setw(12) << "Save" << std::right << std::setw(10) << std::setprecision(3) << queueMs << " ms on the caller, "
+		<< saveMs << " ms until written" << std::endl;
+	std::cout << "  " << std::left << std::setw(12) << "Load" << std::right << std::setw(10) << coldMs * 1000 / world.GetChunkCount() << " us per chunk first, "
+		<< warmMs * 1000 / world.GetChunkCount() << " us mapped, " << (isEqual ? "matches" : "DIFFERS FROM") << " the saved voxels" << std::endl;
+}
+
+//Generates a block of chunks reaching from the caves to the sky, once per SIMD level and with an increasing amount of workers. Every run
+//has to produce the same voxels, whatever the level and thread count.
+void BenchmarkTerrainGeneration(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Terrain generation " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	const TerrainGenerator generator{};
+	const size_t totalCount = size_t(chunkCount.x) * chunkCount.y * chunkCount.z;
+	std::vector<uint64_t> checksums(totalCount);
+	std::vector<uint8_t> isUniform(totalCount);
+	auto generate = [&](ThreadPool& threadPool, SimdLevel level)
+	{
+		threadPool.ParallelFor(totalCount, 4, [&](size_t begin, size_t end)
+		{
+			Array3D<uint32_t> voxels{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+			for (size_t i = begin; i < end; i++)
+			{
+				const glm::ivec3 chunkCoord{ int(i / (chunkCount.y * chunkCount.z)), int(i / chunkCount.z % chunkCount.y) - chunkCount.y / 2, int(i % chunkCount.z) };
+				isUniform[i] = generator.Generate(chunkCoord, voxels, level) ? 1 : 0;
+				uint64_t checksum = 14695981039346656037ull;
+				for (size_t v = 0; v < voxels.GetSize(); v++)
+				{
+					checksum = (checksum ^ voxels.Data()[v]) * 1099511628211ull;
+				}
+				checksums[i] = checksum;
+			}
+		});
+	};
+	auto print = [&](const std::string& name, float ms, float referenceMs, bool isMatching)
+	{
+		std::cout << "  " << std::left << std::setw(18) << name << std::right << std::fixed
+			<< std::setw(10) << std::setprecision(1) << totalCount / (ms / 1000) << " chunks/s"
+			<< std::setw(10) << std::setprecision(3) << ms << " ms"
+			<< std::setw(8) << std::setprecision(2) << referenceMs / ms << "x"
+			<< (isMatching ? "" : "  MISMATCH") << std::endl;
+	};
+
+	const size_t maxThreadCount = GetMaxThreadCount();
+	std::vector<uint64_t> referenceChecksums;
+	float referenceMs = 0.f;
+	{
+		ThreadPool threadPool{ maxThreadCount };
+		for (SimdLevel level : GetSupportedSimdLevels())
+		{
+			const float ms = MeasureMs([&]() { generate(threadPool, level); }, 3);
+			if (level == SimdLevel::Scalar)
+			{
+				referenceChecksums = checksums;
+				referenceMs = ms;
+			}
+			print(std::string(GetSimdLevelName(level)) + " " + std::to_string(maxThreadCount) + " threads", ms, referenceMs, checksums == referenceChecksums);
+		}
+	}
+	MeasureThreadScaling([&](ThreadPool& threadPool) { generate(threadPool, GetSupportedSimdLevel()); }, 3, [&](size_t threadCount, float ms, float singleThreadMs)
+	{
+		print(std::to_string(threadCount) + " threads", ms, singleThreadMs, checksums == referenceChecksums);
+	});
+	std::cout << "  " << std::count(isUniform.begin(), isUniform.end(), uint8_t(1)) << " of " << totalCount << " chunks uniform" << std::endl;
+}
+
+//Interleaving the attribute streams of a subdivided plane into a vertex buffer, as done when meshes are batched.
+void BenchmarkMeshInterleave(int subdivision)
+{
+	Mesh* pPlane = CreatePlaneMesh(1.f, 1.f, { subdivision, subdivision }, { 1.f, 1.f, 1.f, 1.f });
+	using Layout = VertexLayoutT<VertexAttribute::POSITION, VertexAttribute::UV, VertexAttribute::NORMAL, VertexAttribute::COLOR>;
+	const std::vector<VertexAttribute> attributes = Layout::GetAttributes();
+	const size_t vertexCount = pPlane->GetVertexCount(attributes);
+	std::cout << "Mesh interleave, " << vertexCount << " vertices" << std::endl;
+	std::vector<float> vertices(pPlane->GetVertexDataSize(attributes) / sizeof(float));
+	const glm::mat4x4 transforms[] = { glm::mat4x4(1.f), glm::translate(glm::mat4x4(1.f), { 1.f, 2.f, 3.f }) };
+	const char* names[] = { "Identity", "Transformed" };
+	for (int i = 0; i < 2; i++)
+	{
+		float runtimeMs = MeasureMs([&]() { pPlane->CreateVertices(attributes, vertices.data(), transforms[i]); }, 10);
+		float layoutMs = MeasureMs([&]() { pPlane->CreateVertices(Layout{}, vertices.data(), transforms[i]); }, 10);
+		std::cout << "  " << std::left << std::setw(14) << names[i] << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << runtimeMs << " ms runtime layout" << std::setw(10) << layoutMs << " ms VertexLayoutT"
+			<< std::setprecision(1) << std::setw(10) << vertexCount / (layoutMs * 1000.f) << " M vertices/s" << std::endl;
+	}
+	delete pPlane;
+}
+
+//Batch transform kernels against one glm::mat4 * vec4 per vector, on separate x, y, z arrays and on the positions and normals of
+//interleaved POSITION, COLOR, NORMAL vertices.
+void BenchmarkVertexTransform(size_t count)
+{
+	std::cout << "Vertex transform, " << count << " vectors" << std::endl;
+	std::mt19937 random{ 11 };
+	std::uniform_real_distribution<float> distribution{ -100.f, 100.f };
+	const size_t stride = FloatVoxelLayout::Stride / sizeof(float);
+	std::vector<float> vertices(count * stride);
+	for (float& value : vertices)
+	{
+		value = distribution(random);
+	}
+	std::vector<float> soa[3];
+	for (int c = 0; c < 3; c++)
+	{
+		soa[c].resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			soa[c][i] = vertices[i * stride + c];
+		}
+	}
+	std::vector<float> destination(vertices.size());
+	std::vector<float> soaDestination[3] = { std::vector<float>(count), std::vector<float>(count), std::vector<float>(count) };
+	const float* pSoa[3] = { soa[0].data(), soa[1].data(), soa[2].data() };
+	float* pSoaDestination[3] = { soaDestination[0].data(), soaDestination[1].data(), soaDestination[2].data() };
+	const glm::mat4x4 transform = glm::scale(glm::rotate(glm::translate(glm::mat4x4(1.f), { 1.f, 2.f, 3.f }), 0.5f, { 0.f, 1.f, 0.f }), { 2.f, 1.f, 1.f });
+	const size_t normalOffset = FloatVoxelLayout::GetOffset(2) / sizeof(float);
+	const int iterations = 100;
+
+	const float glmPointMs = MeasureMs([&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const glm::vec4 point = transform * glm::vec4(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2], 1.f);
+			memcpy(&destination[i * stride], &point, 3 * sizeof(float));
+		}
+	}, iterations);
+	const glm::mat3x3 normalMatrix = glm::transpose(glm::inverse(glm::mat3x3(transform)));
+	const float glmNormalMs = MeasureMs([&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const glm::vec3 normal = glm::normalize(normalMatrix * glm::vec3(vertices[i * stride + normalOffset], vertices[i * stride + normalOffset + 1], vertices[i * stride + normalOffset + 2]));
+			memcpy(&destination[i * stride + normalOffset], &normal, 3 * sizeof(float));
+		}
+	}, iterations);
+	std::cout << "  " << std::left << std::setw(16) << "glm" << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(28) << count / (glmPointMs * 1000.f) << " M points/s" << std::setw(10) << count / (glmNormalMs * 1000.f) << " M normals/s strided" << std::endl;
+
+	for (SimdLevel level : GetSupportedSimdLevels())
+	{
+		const float soaMs = MeasureMs([&]() { TransformVectors(pSoa, pSoaDestination, count, transform, TransformType::Point, level); }, iterations);
+		const float pointMs = MeasureMs([&]() { TransformVectors(vertices.data(), stride, destination.data(), stride, count, transform, TransformType::Point, level); }, iterations);
+		const float normalMs = MeasureMs([&]()
+		{
+			TransformVectors(vertices.data() + normalOffset, stride, destination.data() + normalOffset, stride, count, transform, TransformType::Normal, level);
+		}, iterations);
+		std::cout << "  " << std::left << std::setw(16) << GetSimdLevelName(level) << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << count / (soaMs * 1000.f) << " M points/s SoA" << std::setw(10) << count / (pointMs * 1000.f) << " M points/s"
+			<< std::setw(10) << count / (normalMs * 1000.f) << " M normals/s strided, " << std::setprecision(2) << glmPointMs / pointMs << "x glm" << std::endl;
+	}
+}
+
+//Batching copies of the cube indices as GenerateCubeMesh does: the former copy into a temporary vector per mesh, the direct write and
+//the bulk write of all copies in one call.
+void BenchmarkIndexOffset(size_t copyCount)
+{
+	Mesh* pCube = CreateCubeMesh(1.f, { 0.f, 0.f }, { 1.f, 1.f, 1.f, 1.f });
+	const std::vector<uint32_t>& cubeIndices = pCube->GetIndices();
+	const uint32_t vertexStep = uint32_t(pCube->GetVertexCount(FloatVoxelLayout{}));
+	std::vector<uint32_t> indices(cubeIndices.size() * copyCount);
+	const int iterations = 20;
+	const float copyMs = MeasureMs([&]()
+	{
+		uint32_t* pWrite = indices.data();
+		for (size_t i = 0; i < copyCount; i++)
+		{
+			std::vector<uint32_t> offsetIndices = cubeIndices;
+			for (uint32_t& index : offsetIndices)
+			{
+				index += uint32_t(i) * vertexStep;
+			}
+			memcpy(pWrite, offsetIndices.data(), offsetIndices.size() * sizeof(uint32_t));
+			pWrite += offsetIndices.size();
+		}
+	}, iterations);
+	const float directMs = MeasureMs([&]()
+	{
+		uint32_t* pWrite = indices.data();
+		for (size_t i = 0; i < copyCount; i++)
+		{
+			pWrite = pCube->GetIndices(uint32_t(i) * vertexStep, pWrite);
+		}
+	}, iterations);
+	const float bulkMs = MeasureMs([&]() { pCube->GetIndices(0, vertexStep, copyCount, indices.data()); }, iterations);
+	std::cout << "Index offset, " << copyCount << " cubes" << std::endl;
+	std::cout << "  " << std::fixed << std::setprecision(3) << "Temporary copy " << copyMs << " ms, direct " << directMs << " ms, bulk " << bulkMs << " ms, "
+		<< std::setprecision(1) << copyMs / bulkMs << "x faster" << std::endl;
+	delete pCube;
+}
+
+//Neighbours of a chunk for the mesher, only those isNeighbour accepts.
+VoxelChunkNeighbours GetChunkNeighbours(const VoxelWorld& world, size_t chunkId, const std::function<bool(size_t)>& isNeighbour)
+{
+	VoxelChunkNeighbours neighbours{};
+	for (size_t faceId = 0; faceId < 6; faceId++)
+	{
+		const size_t neighbourId = world.GetNeighbourId(chunkId, faceId);
+		if (neighbourId != VoxelWorld::InvalidChunkId && isNeighbour(neighbourId))
+			neighbours.pData[faceId] = world.GetChunk(neighbourId)->GetSharedData();
+	}
+	return neighbours;
+}
+
+//Triangles of a world meshed chunk by chunk with closed borders against culling the borders with the neighbour aprons.
+void BenchmarkNeighbourCulling(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Neighbour culling, " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	ThreadPool threadPool{};
+	const char* sceneNames[] = { "Solid", "Terrain" };
+	for (int sceneId = 0; sceneId < 2; sceneId++)
+	{
+		VoxelWorld world{ chunkCount, chunkSize };
+		if (sceneId == 0)
+		{
+			for (size_t i = 0; i < world.GetChunkCount(); i++)
+			{
+				world.SetChunkData(i, BrickMap{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize), 1 });
+			}
+		}
+		else
+		{
+			FillTerrainWorld(world);
+		}
+		const MeshingMode modes[] = { MeshingMode::CulledFaces, MeshingMode::Greedy };
+		for (MeshingMode mode : modes)
+		{
+			size_t triangleCounts[2] = {};
+			float meshingMs[2] = {};
+			for (int useNeighbours = 0; useNeighbours < 2; useNeighbours++)
+			{
+				ChunkMesher mesher{ &threadPool };
+				std::vector<ChunkMeshResult> results;
+				meshingMs[useNeighbours] = MeasureMs([&]()
+				{
+					for (size_t i = 0; i < world.GetChunkCount(); i++)
+					{
+						const VoxelChunkNeighbours neighbours = GetChunkNeighbours(world, i, [useNeighbours](size_t) { return useNeighbours != 0; });
+						mesher.Submit(i, *world.GetChunk(i), mode, VoxelVertexFormat::Packed, 0, neighbours);
+					}
+					mesher.Wait();
+					results.clear();
+					mesher.PopResults(results);
+				}, 1);
+				for (const ChunkMeshResult& result : results)
+				{
+					triangleCounts[useNeighbours] += result.Mesh.GetIndexCount() / 3;
+				}
+			}
+			const std::string name = std::string(sceneNames[sceneId]) + (mode == MeshingMode::Greedy ? " greedy" : " culled");
+			std::cout << "  " << std::left << std::setw(16) << name << std::right << std::setw(10) << triangleCounts[0] << " triangles closed"
+				<< std::setw(10) << triangleCounts[1] << " culled" << std::fixed << std::setprecision(2) << std::setw(8)
+				<< float(triangleCounts[0]) / glm::max(triangleCounts[1], size_t(1)) << "x fewer, meshing "
+				<< std::setprecision(1) << meshingMs[0] << " / " << meshingMs[1] << " ms" << std::endl;
+		}
+	}
+}
+
+//Index memory of the terrain chunks with 32 bit indices and with the width the index buffers pick from the vertex count, and the
+//cost of narrowing the indices while uploading them.
+void BenchmarkIndexWidth(const glm::ivec3& chunkCount, int chunkSize)
+{
+	std::cout << "Index width, " << chunkCount.x << "x" << chunkCount.y << "x" << chunkCount.z << " chunks of " << chunkSize << "^3" << std::endl;
+	ThreadPool threadPool{};
+	VoxelWorld world{ chunkCount, chunkSize };
+	FillTerrainWorld(world);
+	const MeshingMode modes[] = { MeshingMode::CulledFaces, MeshingMode::Greedy };
+	for (MeshingMode mode : modes)
+	{
+		ChunkMesher mesher{ &threadPool };
+		for (size_t i = 0; i < world.GetChunkCount(); i++)
+		{
+			mesher.Submit(i, *world.GetChunk(i), mode, VoxelVertexFormat::Packed, 0, GetChunkNeighbours(world, i, [](size_t) { return true; }));
+		}
+		mesher.Wait();
+		std::vector<ChunkMeshResult> results;
+		mesher.PopResults(results);
+
+		size_t wideSize = 0;
+		size_t automaticSize = 0;
+		size_t narrowCount = 0;
+		size_t meshCount = 0;
+		std::vector<uint32_t> wideIndices;
+		std::vector<uint16_t> narrowIndices;
+		for (const ChunkMeshResult& result : results)
+		{
+			const std::vector<uint32_t>& indices = result.Mesh.Indices;
+			if (indices.empty())
+				continue;
+			const IndexType type = GetIndexType(result.Mesh.GetVertexDataSize() / result.Mesh.GetVertexSize());
+			wideSize += indices.size() * sizeof(uint32_t);
+			automaticSize += indices.size() * GetIndexTypeSize(type);
+			narrowCount += type == IndexType::UINT16 ? 1 : 0;
+			meshCount++;
+			wideIndices.resize(std::max(wideIndices.size(), indices.size()));
+			narrowIndices.resize(std::max(narrowIndices.size(), indices.size()));
+		}
+		const int iterations = 20;
+		const float wideMs = MeasureMs([&]()
+		{
+			for (const ChunkMeshResult& result : results)
+			{
+				OffsetIndices(result.Mesh.Indices.data(), result.Mesh.Indices.size(), 0, wideIndices.data());
+			}
+		}, iterations);
+		const float narrowMs = MeasureMs([&]()
+		{
+			for (const ChunkMeshResult& result : results)
+			{
+				if (GetIndexType(result.Mesh.GetVertexDataSize() / result.Mesh.GetVertexSize()) == IndexType::UINT16)
+					OffsetIndices(result.Mesh.Indices.data(), result.Mesh.Indices.size(), 0, narrowIndices.data());
+				else
+					OffsetIndices(result.Mesh.Indices.data(), result.Mesh.Indices.size(), 0, wideIndices.data());
+			}
+		}, iterations);
+		std::cout << "  " << std::left << std::setw(16) << (mode == MeshingMode::Greedy ? "Greedy" : "Culled faces") << std::right << std::setw(6) << narrowCount
+			<< " of " << meshCount << " meshes 16 bit" << std::fixed << std::setprecision(2) << std::setw(8) << wideSize / (1024.f * 1024.f) << " MB 32 bit"
+			<< std::setw(8) << automaticSize / (1024.f * 1024.f) << " MB automatic, staging " << std::setprecision(3) << wideMs << " / " << narrowMs << " ms" << std::endl;
+	}
+}
+
+//Streams in the terrain around the camera for growing view distances and meshes it once at full resolution and once with the clipmap
+//levels of detail. The triangle count stands in for the frame time, which is what has to stay flat as the view distance grows.
+void BenchmarkLod(int chunkSize, int lodRadius, const std::vector<int>& loadRadii)
+{
+	std::cout << "Levels of detail, chunks of " << chunkSize << "^3, full resolution up to " << lodRadius << " chunks" << std::endl;
+	const TerrainGenerator generator{};
+	ThreadPool threadPool{};
+	for (int loadRadius : loadRadii)
+	{
+		VoxelWorld world{ chunkSize };
+		ChunkStreamingSettings settings{};
+		settings.LoadRadius = loadRadius;
+		settings.UnloadRadius = loadRadius;
+		settings.LodRadius = lodRadius;
+		settings.MaxGenerateJobs = 64;
+		settings.MaxAddedChunks = 1024;
+		ChunkStreamer streamer{ &world, &threadPool, [&generator](const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels) { generator.Generate(chunkCoord, voxels); }, settings };
+		const glm::vec3 cameraPosition{ 0.f, generator.GetSurfaceHeight(0.f, 0.f) + 8.f, 0.f };
+		std::vector<size_t> addedChunks;
+		std::vector<size_t> removedChunks;
+		do
+		{
+			streamer.Update(cameraPosition, { 1.f, 0.f, 0.f }, addedChunks, removedChunks);
+			std::this_thread::yield();
+		} while (streamer.GetMissingCount() > 0 || streamer.GetGeneratingCount() > 0);
+
+		size_t triangleCounts[2] = {};
+		float meshingMs[2] = {};
+		for (int useLod = 0; useLod < 2; useLod++)
+		{
+			ChunkMesher mesher{ &threadPool };
+			std::vector<ChunkMeshResult> results;
+			meshingMs[useLod] = MeasureMs([&]()
+			{
+				for (size_t i = 0; i < world.GetChunkCount(); i++)
+				{
+					const int lod = useLod ? streamer.GetChunkLod(world.GetChunkCoord(i)) : 0;
+					//Borders towards a chunk of another level stay closed, like in the app.
+					const VoxelChunkNeighbours neighbours = GetChunkNeighbours(world, i, [&](size_t neighbourId)
+					{
+						return (useLod ? streamer.GetChunkLod(world.GetChunkCoord(neighbourId)) : 0) == lod;
+					});
+					mesher.Submit(i, *world.GetChunk(i), MeshingMode::Greedy, VoxelVertexFormat::Packed, lod, neighbours);
+				}
+				mesher.Wait();
+				results.clear();
+				mesher.PopResults(results);
+			}, 1);
+			for (const ChunkMeshResult& result : results)
+			{
+				triangleCounts[useLod] += result.Mesh.GetIndexCount() / 3;
+			}
+		}
+		std::cout << "  " << std::left << std::setw(10) << ("radius " + std::to_string(loadRadius)) << std::right << std::setw(7) << world.GetResidentChunkCount() << " chunks"
+			<< std::setw(10) << triangleCounts[0] << " triangles full" << std::setw(9) << triangleCounts[1] << " with LOD"
+			<< std::fixed << std::setprecision(2) << std::setw(7) << float(triangleCounts[0]) / triangleCounts[1] << "x fewer, meshing "
+			<< std::setprecision(1) << meshingMs[0] << " / " << meshingMs[1] << " ms" << std::endl;
+	}
+}
+
+int main()
+{
+	const size_t chunkSizes[] = { 16, 32, 64 };
+	for (size_t size : chunkSizes)
+	{
+		BenchmarkMeshing("Solid", CreateSolidVolume(size));
+		BenchmarkMeshing("Terrain", CreateTerrainVolume(size));
+	}
+	for (size_t size : chunkSizes)
+	{
+		BenchmarkRaycast(size);
+	}
+	BenchmarkStorage({ 16, 4, 16 }, 32);
+	BenchmarkArrayOps(128);
+	BenchmarkRayBoxes(4096, 1024);
+	BenchmarkWorldRaycast({ 16, 4, 16 }, 16);
+	BenchmarkBatchRaycast({ 16, 4, 16 }, 16);
+	BenchmarkParallelMeshing(16, 16);
+	BenchmarkStreaming(16, 6, 4.f);
+	BenchmarkRegionFiles({ 16, 4, 16 }, 32);
+	BenchmarkTerrainGeneration({ 16, 12, 16 }, 16);
+	BenchmarkTerrainGeneration({ 8, 6, 8 }, 32);
+	BenchmarkMeshInterleave(1024);
+	BenchmarkVertexTransform(1 << 16);
+	BenchmarkIndexOffset(32 * 32 * 32);
+	BenchmarkNeighbourCulling({ 8, 8, 8 }, 16);
+	BenchmarkNeighbourCulling({ 16, 4, 16 }, 16);
+	BenchmarkIndexWidth({ 16, 4, 16 }, 16);
+	BenchmarkIndexWidth({ 8, 2, 8 }, 64);
+	BenchmarkLod(16, 4, { 4, 8, 12 });
+	return 0;
+}
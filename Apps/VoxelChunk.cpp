@@ -1,145 +1,663 @@
 #include "VoxelChunk.h"
-#include <DataHandling/MeshShapes.h>
-#include <glm/gtc/matrix_transform.hpp>
+#include <Base/GridTraversal.h>
 #include <iostream>
+#include <algorithm>
 
 VoxelChunk::VoxelChunk(const Array3D<uint32_t>& data, const glm::vec3& position)
-	:m_VoxelData{data}
+	:VoxelChunk(BrickMap{ data }, position)
+{
+}
+
+VoxelChunk::VoxelChunk(const BrickMap& data, const glm::vec3& position)
+	:VoxelChunk(std::make_shared<VoxelChunkData>(data), position)
+{
+}
+
+VoxelChunk::VoxelChunk(const std::shared_ptr<VoxelChunkData>& pData, const glm::vec3& position)
+	:m_pData{pData}
 	,m_Position{position}
 {
+	const glm::ivec3 sectionCount = GetSectionCount();
+	m_DirtySections.resize(size_t(sectionCount.x) * sectionCount.y * sectionCount.z);
+}
+
+VoxelChunkData::VoxelChunkData(const BrickMap& voxels)
+	:Voxels{voxels}
+	,Occupancy{voxels.GetWidth(), voxels.GetHeight(), voxels.GetDepth()}
+{
+	Occupancy.Build(Voxels);
+}
+
+//Every face is a quad spanned by U and V from Origin, with cross(U, V) pointing along the normal so the winding matches CreateCubeMesh.
+struct VoxelFace
+{
+	glm::ivec3 Normal;
+	glm::vec3 Origin;
+	glm::vec3 U;
+	glm::vec3 V;
+};
+
+const VoxelFace VoxelFaces[6] =
+{
+	{ { 1, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } },
+	{ {-1, 0, 0 }, { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } },
+	{ { 0, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 0 } },
+	{ { 0,-1, 0 }, { 0, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 } },
+	{ { 0, 0, 1 }, { 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 } },
+	{ { 0, 0,-1 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 } },
+};
+
+const glm::vec4 VoxelColor{ 0.3f, 0.6f, 0.f, 1.f };
+const size_t VoxelVertexSize = 10; //POSITION, COLOR, NORMAL in floats
+const size_t PackedVoxelVertexSize = 2; //UBYTE4, UINT
+
+void VoxelMesh::Clear()
+{
+	Vertices.clear();
+	PackedVertices.clear();
+	Indices.clear();
+	Sections.clear();
 }
 
-void VoxelChunk::GenerateMesh()
+const void* VoxelMesh::GetVertexData() const
 {
-	Mesh* cubeMesh = CreateCubeMesh(1.f, { 0.f,0.f }, { 0.3f, 0.6f, 0.f, 1.f });
-	std::vector<VertexAttribute> attributes = { VertexAttribute::POSITION, VertexAttribute::COLOR, VertexAttribute::NORMAL };
-	size_t cubeDataSize = cubeMesh->GetVertexDataSize(attributes) / sizeof(float);
+	if (Format == VoxelVertexFormat::Packed)
+		return PackedVertices.data();
+	return Vertices.data();
+}
 
-	const size_t size{ m_VoxelData.GetDepth() };
-	m_Vertices.clear();
-	m_Vertices.resize(size * size * size * cubeDataSize);
-	float* writePos = m_Vertices.data();
-	size_t vertexOffset = 0;
-	m_Indices.clear();
-	m_Indices.resize(cubeMesh->GetIndexCount() * size * size * size);
-	uint32_t* indexWritePos = m_Indices.data();
+size_t VoxelMesh::GetVertexDataSize() const
+{
+	if (Format == VoxelVertexFormat::Packed)
+		return PackedVertices.size() * sizeof(uint32_t);
+	return Vertices.size() * sizeof(float);
+}
+
+size_t VoxelMesh::GetVertexSize() const
+{
+	if (Format == VoxelVertexFormat::Packed)
+		return PackedVoxelVertexSize * sizeof(uint32_t);
+	return VoxelVertexSize * sizeof(float);
+}
+
+size_t VoxelMesh::GetVertexCount() const
+{
 	size_t vertexCount = 0;
+	for (const VoxelMeshSection& section : Sections)
+	{
+		vertexCount += section.VertexCount;
+	}
+	return vertexCount;
+}
+
+size_t VoxelMesh::GetIndexCount() const
+{
 	size_t indexCount = 0;
-	for (size_t y = 0; y < size; y++)
+	for (const VoxelMeshSection& section : Sections)
+	{
+		indexCount += section.IndexCount;
+	}
+	return indexCount;
+}
+
+//Room every section gets to grow before the whole chunk has to be laid out again.
+size_t GetSectionQuadCapacity(size_t quadCount)
+{
+	const size_t minSlackQuads = 8;
+	return quadCount + std::max(quadCount / 4, minSlackQuads);
+}
+
+//Copies a section meshed in source into its slot in mesh and fills the unused indices with degenerate triangles.
+void CopySection(VoxelMesh& mesh, size_t sectionId, const VoxelMesh& source, const VoxelMeshSection& sourceSection)
+{
+	VoxelMeshSection& section = mesh.Sections[sectionId];
+	assert(sourceSection.VertexCount <= section.VertexCapacity && sourceSection.IndexCount <= section.IndexCapacity && "Section does not fit its slot!");
+	section.VertexCount = sourceSection.VertexCount;
+	section.IndexCount = sourceSection.IndexCount;
+	if (mesh.Format == VoxelVertexFormat::Packed)
+	{
+		std::copy_n(source.PackedVertices.data() + sourceSection.FirstVertex * PackedVoxelVertexSize, section.VertexCount * PackedVoxelVertexSize, mesh.PackedVertices.data() + section.FirstVertex * PackedVoxelVertexSize);
+	}
+	else
+	{
+		std::copy_n(source.Vertices.data() + sourceSection.FirstVertex * VoxelVertexSize, section.VertexCount * VoxelVertexSize, mesh.Vertices.data() + section.FirstVertex * VoxelVertexSize);
+	}
+
+	uint32_t* writePos = mesh.Indices.data() + section.FirstIndex;
+	const uint32_t* readPos = source.Indices.data() + sourceSection.FirstIndex;
+	const uint32_t vertexOffset = uint32_t(section.FirstVertex - sourceSection.FirstVertex);
+	for (size_t i = 0; i < section.IndexCount; i++)
 	{
-		for (size_t z = 0; z < size; z++)
+		writePos[i] = readPos[i] + vertexOffset;
+	}
+	std::fill(writePos + section.IndexCount, writePos + section.IndexCapacity, uint32_t(section.FirstVertex));
+}
+
+void VoxelChunk::GenerateMesh(MeshingMode mode, VoxelVertexFormat format, int lod, const VoxelChunkNeighbours& neighbours)
+{
+	GenerateMesh(m_VoxelMesh, mode, format, lod, neighbours);
+	std::fill(m_DirtySections.begin(), m_DirtySections.end(), false);
+	m_HasDirtySections = false;
+}
+
+void VoxelChunk::GenerateMesh(VoxelMesh& mesh, MeshingMode mode, VoxelVertexFormat format, int lod, const VoxelChunkNeighbours& neighbours) const
+{
+	const VoxelApron apron = CreateApron(neighbours, lod);
+	if (lod == 0)
+	{
+		GenerateSectionedMesh(mesh, mode, format, 0, apron);
+		return;
+	}
+	const VoxelChunk lodChunk{ CreateLodData(lod), m_Position };
+	lodChunk.GenerateSectionedMesh(mesh, mode, format, lod, apron);
+}
+
+int GetFaceAxis(const glm::vec3& direction)
+{
+	return direction.x != 0 ? 0 : (direction.y != 0 ? 1 : 2);
+}
+
+//Reads the voxels in [min, max) and halves them levels times along every axis, every voxel takes the most common value of the 2x2x2
+//voxels it covers with ties going to solid values. The region has to be a multiple of 2^levels.
+static Array3D<uint32_t> ReadDownsampled(const BrickMap& data, const glm::ivec3& min, const glm::ivec3& max, int levels)
+{
+	glm::ivec3 size = max - min;
+	assert(size % (1 << levels) == glm::ivec3(0) && "Region has to be a multiple of the voxel size of the level!");
+	Array3D<uint32_t> voxels{ size_t(size.x), size_t(size.y), size_t(size.z) };
+	data.Read(min, max, voxels.Data());
+	for (int level = 1; level <= levels; level++)
+	{
+		const glm::ivec3 lodSize = size / 2;
+		Array3D<uint32_t> lodVoxels{ size_t(lodSize.x), size_t(lodSize.y), size_t(lodSize.z) };
+		for (int x = 0; x < lodSize.x; x++)
 		{
-			for (size_t x = 0; x < size; x++)
+			for (int y = 0; y < lodSize.y; y++)
 			{
-				if (m_VoxelData[x][y][z] != 0)
+				for (int z = 0; z < lodSize.z; z++)
 				{
-					if (x != 0 && y != 0 && z != 0 && x != m_VoxelData.GetWidth()-1 && y != m_VoxelData.GetHeight()-1 && z != m_VoxelData.GetDepth()-1)
+					uint32_t values[8];
+					for (int i = 0; i < 8; i++)
 					{
-						if (m_VoxelData[x + 1][y][z] != 0 && m_VoxelData[x][y + 1][z] != 0 && m_VoxelData[x][y][z + 1] != 0
-							&& m_VoxelData[x - 1][y][z] != 0 && m_VoxelData[x][y - 1][z] != 0 && m_VoxelData[x][y][z - 1])
-						{
-						}
-						else
-						{
-							vertexCount += cubeDataSize;
-							indexCount += cubeMesh->GetIndexCount();
-							glm::mat4x4 translation = glm::translate(glm::mat4x4(1.f), { x+m_Position.x+0.5f, y+m_Position.y+0.5f , z+m_Position.z+0.5f });
-							writePos = cubeMesh->CreateVertices(attributes, writePos, translation);
-							indexWritePos = cubeMesh->GetIndices(vertexOffset, indexWritePos);
-							vertexOffset += cubeMesh->GetVertexCount(attributes);
-						}
+						values[i] = voxels.at(2 * x + (i >> 2), 2 * y + ((i >> 1) & 1), 2 * z + (i & 1));
 					}
-					else
+					uint32_t majorityValue = 0;
+					int majorityCount = 0;
+					for (int i = 0; i < 8; i++)
 					{
-						vertexCount += cubeDataSize;
-						indexCount += cubeMesh->GetIndexCount();
-						glm::mat4x4 translation = glm::translate(glm::mat4x4(1.f), { x+m_Position.x+0.5f, y+m_Position.y+0.5f , z+m_Position.z+0.5f });
-						writePos = cubeMesh->CreateVertices(attributes, writePos, translation);
-						indexWritePos = cubeMesh->GetIndices(vertexOffset, indexWritePos);
-						vertexOffset += cubeMesh->GetVertexCount(attributes);
+						const int count = int(std::count(values, values + 8, values[i]));
+						if (count > majorityCount || (count == majorityCount && majorityValue == 0))
+						{
+							majorityValue = values[i];
+							majorityCount = count;
+						}
 					}
+					lodVoxels.at(x, y, z) = majorityValue;
 				}
 			}
 		}
+		voxels = std::move(lodVoxels);
+		size = lodSize;
 	}
-	m_Vertices.resize(vertexCount);
-	m_Indices.resize(indexCount);
+	return voxels;
 }
 
+std::shared_ptr<VoxelChunkData> VoxelChunk::CreateLodData(int lod) const
+{
+	assert(lod >= 0 && lod <= MaxChunkLod && "Invalid level of detail!");
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	return std::make_shared<VoxelChunkData>(BrickMap{ ReadDownsampled(m_pData->Voxels, { 0, 0, 0 }, size, lod) });
+}
 
-bool VoxelChunk::Raycast(glm::ivec3& voxelId, const Ray& ray, float minDist, float maxDist)
+VoxelApron VoxelChunk::CreateApron(const VoxelChunkNeighbours& neighbours, int lod) const
 {
-	AABox box{ m_Position, {m_VoxelData.GetWidth(), m_VoxelData.GetHeight(), m_VoxelData.GetHeight()} };
-	float tenter, texit;
-	float toffset = 0.0001f; //How much farther the ray traverses through each block to make sure we never hit end on an edge.
-	glm::vec3 pos;
-	float t;
-	if (!IsInChunk(ray.Pos))
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	const int thickness = 1 << lod;
+	VoxelApron apron{};
+	for (size_t faceId = 0; faceId < 6; faceId++)
 	{
-		if (!ray.Intersect(box, tenter, texit))
-			return false;
+		const std::shared_ptr<VoxelChunkData>& pNeighbour = neighbours.pData[faceId];
+		if (!pNeighbour)
+			continue;
+		const BrickMap& voxels = pNeighbour->Voxels;
+		assert(glm::ivec3(voxels.GetWidth(), voxels.GetHeight(), voxels.GetDepth()) == size && "Neighbours have to be the size of the chunk!");
+		//The layer of the neighbour that touches this chunk, at the far side of it for the faces pointing towards -axis.
+		const glm::ivec3& normal = VoxelFaces[faceId].Normal;
+		const int axis = GetFaceAxis(normal);
+		glm::ivec3 min{ 0, 0, 0 };
+		glm::ivec3 max = size;
+		if (normal[axis] > 0)
+			max[axis] = thickness;
 		else
-			t = tenter + toffset;
-	}else
+			min[axis] = size[axis] - thickness;
+		const Array3D<uint32_t> layer = ReadDownsampled(voxels, min, max, lod);
+
+		std::vector<uint64_t>& bits = apron.Layers[faceId];
+		const int rowCount = int(axis == 0 ? layer.GetHeight() : layer.GetWidth());
+		bits.assign(rowCount, 0);
+		for (int row = 0; row < rowCount; row++)
+		{
+			const int bitCount = int(axis == 2 ? layer.GetHeight() : layer.GetDepth());
+			for (int bit = 0; bit < bitCount; bit++)
+			{
+				const uint32_t value = axis == 0 ? layer.at(0, row, bit) : (axis == 1 ? layer.at(row, 0, bit) : layer.at(row, bit, 0));
+				if (value != 0)
+					bits[row] |= uint64_t(1) << bit;
+			}
+		}
+	}
+	return apron;
+}
+
+uint64_t VoxelChunk::GetExposedFaces(int x, int y, size_t faceId, const VoxelApron& apron) const
+{
+	const OccupancyMask& occupancy = m_pData->Occupancy;
+	const glm::ivec3& normal = VoxelFaces[faceId].Normal;
+	const std::vector<uint64_t>& layer = apron.Layers[faceId];
+	if (normal.z != 0)
 	{
-		t = 0;
+		const uint64_t exposedFaces = occupancy.GetExposedFaces(x, y, normal);
+		if (layer.empty() || !((layer[x] >> y) & 1))
+			return exposedFaces;
+		//The neighbour voxel behind the last voxel of the column is occupied.
+		const uint64_t borderBit = normal.z > 0 ? uint64_t(1) << (occupancy.GetDepth() - 1) : 1;
+		return exposedFaces & ~borderBit;
 	}
-	if (t > maxDist)
-		return false;
-	if (t < minDist)
+	const int neighbourX = x + normal.x;
+	const int neighbourY = y + normal.y;
+	const bool isOnBorder = neighbourX < 0 || neighbourY < 0 || neighbourX >= int(occupancy.GetWidth()) || neighbourY >= int(occupancy.GetHeight());
+	if (!isOnBorder || layer.empty())
+		return occupancy.GetExposedFaces(x, y, normal);
+	return occupancy.GetColumn(x, y) & ~layer[normal.x != 0 ? y : x];
+}
+
+void VoxelChunk::GenerateSectionedMesh(VoxelMesh& mesh, MeshingMode mode, VoxelVertexFormat format, int lod, const VoxelApron& apron) const
+{
+	assert(m_pData->Voxels.GetWidth() <= 255 && m_pData->Voxels.GetHeight() <= 255 && m_pData->Voxels.GetDepth() <= 255 && "Chunk too large for packed vertex positions!");
+	//Mesh the sections back to back first, then copy them into slots with room to grow.
+	VoxelMesh sectionMeshes{};
+	sectionMeshes.Format = format;
+	sectionMeshes.Mode = mode;
+	sectionMeshes.Lod = lod;
+	sectionMeshes.Sections.resize(m_DirtySections.size());
+	for (size_t sectionId = 0; sectionId < sectionMeshes.Sections.size(); sectionId++)
+	{
+		VoxelMeshSection& section = sectionMeshes.Sections[sectionId];
+		section.FirstVertex = sectionMeshes.GetVertexDataSize() / sectionMeshes.GetVertexSize();
+		section.FirstIndex = sectionMeshes.Indices.size();
+		GenerateSectionMesh(sectionMeshes, sectionId, apron);
+		section.VertexCount = sectionMeshes.GetVertexDataSize() / sectionMeshes.GetVertexSize() - section.FirstVertex;
+		section.IndexCount = sectionMeshes.Indices.size() - section.FirstIndex;
+	}
+
+	mesh.Clear();
+	mesh.Format = format;
+	mesh.Mode = mode;
+	mesh.Lod = lod;
+	mesh.Sections.resize(sectionMeshes.Sections.size());
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (size_t sectionId = 0; sectionId < mesh.Sections.size(); sectionId++)
+	{
+		VoxelMeshSection& section = mesh.Sections[sectionId];
+		const size_t quadCapacity = GetSectionQuadCapacity(sectionMeshes.Sections[sectionId].IndexCount / 6);
+		section.FirstVertex = vertexCount;
+		section.VertexCapacity = quadCapacity * 4;
+		section.FirstIndex = indexCount;
+		section.IndexCapacity = quadCapacity * 6;
+		vertexCount += section.VertexCapacity;
+		indexCount += section.IndexCapacity;
+	}
+	if (format == VoxelVertexFormat::Packed)
+		mesh.PackedVertices.resize(vertexCount * PackedVoxelVertexSize);
+	else
+		mesh.Vertices.resize(vertexCount * VoxelVertexSize);
+	mesh.Indices.resize(indexCount);
+	for (size_t sectionId = 0; sectionId < mesh.Sections.size(); sectionId++)
+	{
+		CopySection(mesh, sectionId, sectionMeshes, sectionMeshes.Sections[sectionId]);
+	}
+}
+
+void VoxelChunk::MarkDirty(const glm::ivec3& voxelId)
+{
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	const glm::ivec3 neighbours[7] = { { 0, 0, 0 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (const glm::ivec3& offset : neighbours)
+	{
+		const glm::ivec3 neighbour = voxelId + offset;
+		if (glm::any(glm::lessThan(neighbour, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(neighbour, size)))
+			continue;
+		m_DirtySections[GetSectionId(neighbour / VoxelSectionSize)] = true;
+		m_HasDirtySections = true;
+	}
+}
+
+bool VoxelChunk::UpdateDirtySections(std::vector<size_t>& updatedSections, const VoxelChunkNeighbours& neighbours)
+{
+	if (!m_HasDirtySections)
+		return true;
+
+	VoxelMesh sectionMesh{};
+	sectionMesh.Format = m_VoxelMesh.Format;
+	sectionMesh.Mode = m_VoxelMesh.Mode;
+	//The sections of a downsampled mesh do not line up with the dirty sections.
+	bool fitsSlots = m_VoxelMesh.Lod == 0 && m_VoxelMesh.Sections.size() == m_DirtySections.size();
+	const VoxelApron apron = fitsSlots ? CreateApron(neighbours, 0) : VoxelApron{};
+	for (size_t sectionId = 0; sectionId < m_DirtySections.size() && fitsSlots; sectionId++)
+	{
+		if (!m_DirtySections[sectionId])
+			continue;
+
+		sectionMesh.Clear();
+		GenerateSectionMesh(sectionMesh, sectionId, apron);
+		VoxelMeshSection source{};
+		source.VertexCount = sectionMesh.GetVertexDataSize() / sectionMesh.GetVertexSize();
+		source.IndexCount = sectionMesh.Indices.size();
+		const VoxelMeshSection& slot = m_VoxelMesh.Sections[sectionId];
+		if (source.VertexCount > slot.VertexCapacity || source.IndexCount > slot.IndexCapacity)
+		{
+			fitsSlots = false;
+			break;
+		}
+		CopySection(m_VoxelMesh, sectionId, sectionMesh, source);
+		updatedSections.push_back(sectionId);
+	}
+
+	if (!fitsSlots)
+	{
+		GenerateMesh(m_VoxelMesh.Mode, m_VoxelMesh.Format, m_VoxelMesh.Lod, neighbours);
 		return false;
-	pos = ray.Traverse(t);
-	if (!IsInChunk(pos))
+	}
+	std::fill(m_DirtySections.begin(), m_DirtySections.end(), false);
+	m_HasDirtySections = false;
+	return true;
+}
+
+glm::ivec3 VoxelChunk::GetSectionCount() const
+{
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	return (size + VoxelSectionSize - 1) / VoxelSectionSize;
+}
+
+size_t VoxelChunk::GetSectionId(const glm::ivec3& section) const
+{
+	const glm::ivec3 sectionCount = GetSectionCount();
+	return (size_t(section.x) * sectionCount.y + section.y) * sectionCount.z + section.z;
+}
+
+void VoxelChunk::GenerateSectionMesh(VoxelMesh& mesh, size_t sectionId, const VoxelApron& apron) const
+{
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	const glm::ivec3 sectionCount = GetSectionCount();
+	const glm::ivec3 section{ sectionId / (sectionCount.y * sectionCount.z), (sectionId / sectionCount.z) % sectionCount.y, sectionId % sectionCount.z };
+	const glm::ivec3 min = section * VoxelSectionSize;
+	const glm::ivec3 max = glm::min(min + VoxelSectionSize, size);
+	if (IsSectionHidden(section))
+		return;
+	//Decode the section once instead of unpacking a palette index for every face.
+	uint32_t values[VoxelSectionSize * VoxelSectionSize * VoxelSectionSize];
+	m_pData->Voxels.Read(min, max, values);
+	switch (mesh.Mode)
+	{
+	case MeshingMode::Greedy:
+		GenerateGreedyMesh(mesh, min, max, values, apron);
+		break;
+	default:
+		GenerateCulledMesh(mesh, min, max, values, apron);
+		break;
+	}
+}
+
+bool VoxelChunk::IsSectionHidden(const glm::ivec3& section) const
+{
+	static_assert(VoxelSectionSize == BrickSize, "Sections have to line up with the bricks of the voxel data!");
+	const BrickMap& voxels = m_pData->Voxels;
+	if (!voxels.IsBrickUniform(section))
 		return false;
-	glm::ivec3 prevVoxel = GetVoxel(pos);
-	glm::ivec3 currVoxel = GetVoxel(pos);
-	
-	/*for (size_t x = 0; x < m_VoxelData.GetWidth(); x++)
+	if (voxels.GetBrickValue(section) == 0)
+		return true;
+	const glm::ivec3 brickCount = voxels.GetBrickCount();
+	const glm::ivec3 neighbours[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (const glm::ivec3& offset : neighbours)
 	{
-		for (size_t y = 0; y < m_VoxelData.GetHeight(); y++)
+		const glm::ivec3 neighbour = section + offset;
+		if (glm::any(glm::lessThan(neighbour, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(neighbour, brickCount)))
+			return false;
+		if (!voxels.IsBrickUniform(neighbour) || voxels.GetBrickValue(neighbour) == 0)
+			return false;
+	}
+	return true;
+}
+
+void VoxelChunk::GenerateCulledMesh(VoxelMesh& mesh, const glm::ivec3& min, const glm::ivec3& max, const uint32_t* pValues, const VoxelApron& apron) const
+{
+	const glm::ivec3 size = max - min;
+	const uint64_t belowMax = max.z >= 64 ? ~uint64_t(0) : (uint64_t(1) << max.z) - 1;
+	const uint64_t zMask = belowMax & ~((uint64_t(1) << min.z) - 1);
+	for (int x = min.x; x < max.x; x++)
+	{
+		for (int y = min.y; y < max.y; y++)
 		{
-			for (size_t z = 0; z < m_VoxelData.GetDepth(); z++)
+			if ((m_pData->Occupancy.GetColumn(x, y) & zMask) == 0)
+				continue;
+
+			for (size_t faceId = 0; faceId < 6; faceId++)
 			{
-				std::cout << "x: " << x << ", y: " << y << ", z: " << z << " Value: " << m_VoxelData[x][y][z] << std::endl;
+				uint64_t exposedFaces = GetExposedFaces(x, y, faceId, apron) & zMask;
+				while (exposedFaces != 0)
+				{
+					const int z = CountTrailingZeros(exposedFaces);
+					exposedFaces &= exposedFaces - 1;
+					WriteFace(mesh, faceId, { x, y, z }, pValues[(size_t(x - min.x) * size.y + (y - min.y)) * size.z + (z - min.z)]);
+				}
 			}
 		}
-	}*/
-	const int maxSteps = 100.f;
-	int steps = 0;
-	while (m_VoxelData[currVoxel.x][currVoxel.y][currVoxel.z] == 0)
+	}
+}
+
+void VoxelChunk::GenerateGreedyMesh(VoxelMesh& mesh, const glm::ivec3& min, const glm::ivec3& max, const uint32_t* pValues, const VoxelApron& apron) const
+{
+	const glm::ivec3 size = max - min;
+	std::vector<uint32_t> faceMask{};
+	std::vector<uint64_t> exposedColumns(size_t(size.x) * size.y);
+	for (size_t faceId = 0; faceId < 6; faceId++)
 	{
-		if (steps++ >= maxSteps)
-			return false;
-		AABox voxelBounds{ glm::vec3(currVoxel)+m_Position, {1.f, 1.f, 1.f} };
-		if(ray.Intersect(voxelBounds, tenter, texit))
+		const VoxelFace& face = VoxelFaces[faceId];
+		const int normalAxis = GetFaceAxis(face.Normal);
+		const int uAxis = GetFaceAxis(face.U);
+		const int vAxis = GetFaceAxis(face.V);
+		const int uSize = size[uAxis];
+		const int vSize = size[vAxis];
+		faceMask.resize(size_t(uSize) * vSize);
+
+		for (int x = 0; x < size.x; x++)
 		{
-			t = texit + toffset;
-			if (t > maxDist)
-				return false;
-			if (t < minDist)
-				return false;
-		}else
+			for (int y = 0; y < size.y; y++)
+			{
+				exposedColumns[x * size.y + y] = GetExposedFaces(min.x + x, min.y + y, faceId, apron);
+			}
+		}
+
+		for (int slice = 0; slice < size[normalAxis]; slice++)
 		{
-			return false;
+			//Store the material of every visible face in this slice, 0 means no face. Voxel is relative to min.
+			glm::ivec3 voxel{};
+			voxel[normalAxis] = slice;
+			for (int u = 0; u < uSize; u++)
+			{
+				voxel[uAxis] = u;
+				for (int v = 0; v < vSize; v++)
+				{
+					voxel[vAxis] = v;
+					const bool isExposed = (exposedColumns[voxel.x * size.y + voxel.y] >> (min.z + voxel.z)) & 1;
+					faceMask[u * vSize + v] = isExposed ? pValues[(size_t(voxel.x) * size.y + voxel.y) * size.z + voxel.z] : 0;
+				}
+			}
+
+			//Grow each unvisited face along U first, then along V for as long as whole rows match.
+			for (int u = 0; u < uSize; u++)
+			{
+				for (int v = 0; v < vSize;)
+				{
+					const uint32_t material = faceMask[u * vSize + v];
+					if (material == 0)
+					{
+						v++;
+						continue;
+					}
+
+					int width = 1;
+					while (u + width < uSize && faceMask[(u + width) * vSize + v] == material)
+					{
+						width++;
+					}
+
+					int height = 1;
+					bool canGrow = true;
+					while (v + height < vSize && canGrow)
+					{
+						for (int i = 0; i < width; i++)
+						{
+							if (faceMask[(u + i) * vSize + v + height] != material)
+							{
+								canGrow = false;
+								break;
+							}
+						}
+						if (canGrow)
+							height++;
+					}
+
+					for (int i = 0; i < width; i++)
+					{
+						std::fill_n(&faceMask[(u + i) * vSize + v], height, 0);
+					}
+
+					voxel[uAxis] = u;
+					voxel[vAxis] = v;
+					WriteFace(mesh, faceId, min + voxel, material, width, height);
+					v += height;
+				}
+			}
 		}
-		glm::vec3 pos = ray.Traverse(t);
-		currVoxel = GetVoxel(pos);
-		if(!IsInChunk(pos))
+	}
+}
+
+void VoxelChunk::SetVoxelValue(const glm::ivec3& voxelId, uint32_t value)
+{
+	if (GetVoxelValue(voxelId) == value)
+		return;
+	//Copy on write, other chunks or a meshing job might still read the shared data.
+	if (m_pData.use_count() > 1)
+		m_pData = std::make_shared<VoxelChunkData>(*m_pData);
+	m_pData->Voxels.Set(voxelId, value);
+	m_pData->Occupancy.Set(voxelId, value != 0);
+	m_IsModified = true;
+}
+
+void VoxelChunk::SetData(const Array3D<uint32_t>& data)
+{
+	SetData(BrickMap{ data });
+}
+
+void VoxelChunk::SetData(const BrickMap& data)
+{
+	SetData(std::make_shared<VoxelChunkData>(data));
+}
+
+void VoxelChunk::SetData(const std::shared_ptr<VoxelChunkData>& pData)
+{
+	m_pData = pData;
+	const glm::ivec3 sectionCount = GetSectionCount();
+	m_DirtySections.assign(size_t(sectionCount.x) * sectionCount.y * sectionCount.z, false);
+	m_HasDirtySections = false;
+	m_IsModified = true;
+}
+
+void VoxelChunk::WriteFace(VoxelMesh& mesh, size_t faceId, const glm::ivec3& voxelId, uint32_t material, int width, int height) const
+{
+	const VoxelFace& face = VoxelFaces[faceId];
+	const glm::vec3 u = face.U * float(width);
+	const glm::vec3 v = face.V * float(height);
+	const glm::vec3 corners[4] = { face.Origin, face.Origin + u, face.Origin + v, face.Origin + u + v };
+
+	uint32_t vertexOffset{};
+	if (mesh.Format == VoxelVertexFormat::Packed)
+	{
+		vertexOffset = uint32_t(mesh.PackedVertices.size() / PackedVoxelVertexSize);
+		const size_t writeOffset = mesh.PackedVertices.size();
+		mesh.PackedVertices.resize(writeOffset + 4 * PackedVoxelVertexSize);
+		uint32_t* writePos = &mesh.PackedVertices[writeOffset];
+		for (const glm::vec3& corner : corners)
 		{
-			return false;
+			const glm::ivec3 position = voxelId + glm::ivec3(corner);
+			*writePos++ = uint32_t(position.x) | (uint32_t(position.y) << 8) | (uint32_t(position.z) << 16) | (uint32_t(faceId) << 24);
+			*writePos++ = material;
+		}
+	}
+	else
+	{
+		vertexOffset = uint32_t(mesh.Vertices.size() / VoxelVertexSize);
+		const float scale = mesh.GetVoxelScale();
+		const size_t writeOffset = mesh.Vertices.size();
+		mesh.Vertices.resize(writeOffset + 4 * VoxelVertexSize);
+		float* writePos = &mesh.Vertices[writeOffset];
+		for (const glm::vec3& corner : corners)
+		{
+			const glm::vec3 position = m_Position + (glm::vec3(voxelId) + corner) * scale;
+			*writePos++ = position.x;
+			*writePos++ = position.y;
+			*writePos++ = position.z;
+			*writePos++ = VoxelColor.r;
+			*writePos++ = VoxelColor.g;
+			*writePos++ = VoxelColor.b;
+			*writePos++ = VoxelColor.a;
+			*writePos++ = float(face.Normal.x);
+			*writePos++ = float(face.Normal.y);
+			*writePos++ = float(face.Normal.z);
 		}
 	}
-	voxelId = currVoxel;
-	return true;
 
+	const uint32_t quadIndices[6] = { 0, 1, 2, 2, 1, 3 };
+	for (uint32_t index : quadIndices)
+	{
+		mesh.Indices.push_back(vertexOffset + index);
+	}
+}
+
+std::vector<VertexAttribute> VoxelChunk::GetVertexAttributes(VoxelVertexFormat format)
+{
+	if (format == VoxelVertexFormat::Packed)
+		return PackedVoxelLayout::GetAttributes();
+	return FloatVoxelLayout::GetAttributes();
+}
+
+
+bool VoxelChunk::Raycast(VoxelHit& hit, const Ray& ray, float minDist, float maxDist) const
+{
+	const glm::ivec3 size{ m_pData->Voxels.GetWidth(), m_pData->Voxels.GetHeight(), m_pData->Voxels.GetDepth() };
+	GridTraversal traversal{};
+	if (!traversal.Init(ray, m_Position, size, 1.f, minDist, maxDist))
+		return false;
+	do
+	{
+		if (m_pData->Occupancy.IsSet(traversal.GetCell()))
+		{
+			hit.VoxelId = traversal.GetCell();
+			hit.Normal = traversal.GetNormal();
+			hit.Distance = traversal.GetEnterDistance();
+			return true;
+		}
+	} while (traversal.Step());
+	return false;
 }
 
-const glm::ivec3& VoxelChunk::GetVoxel(glm::vec3 position)
+glm::ivec3 VoxelChunk::GetVoxel(glm::vec3 position) const
 {
 	glm::ivec3 voxelId;
-	voxelId.x = glm::min(glm::max(int(floor(position.x - m_Position.x)), 0), int(m_VoxelData.GetWidth()-1));
-	voxelId.y = glm::min(glm::max(int(floor(position.y - m_Position.y)), 0), int(m_VoxelData.GetHeight()-1));
-	voxelId.z = glm::min(glm::max(int(floor(position.z - m_Position.z)), 0), int(m_VoxelData.GetDepth()-1));
+	voxelId.x = glm::min(glm::max(int(floor(position.x - m_Position.x)), 0), int(m_pData->Voxels.GetWidth()-1));
+	voxelId.y = glm::min(glm::max(int(floor(position.y - m_Position.y)), 0), int(m_pData->Voxels.GetHeight()-1));
+	voxelId.z = glm::min(glm::max(int(floor(position.z - m_Position.z)), 0), int(m_pData->Voxels.GetDepth()-1));
 	return voxelId;
 }
 
@@ -147,7 +665,7 @@ bool VoxelChunk::IsInChunk(glm::vec3 pos) const
 {
 	glm::vec3 transPos{ pos - m_Position };
 	return !(transPos.x < 0 || transPos.y < 0 || transPos.z < 0
-		|| transPos.x > float(m_VoxelData.GetWidth()) || transPos.y > float(m_VoxelData.GetHeight()) || transPos.z-FLT_EPSILON > float(m_VoxelData.GetDepth()));
+		|| transPos.x > float(m_pData->Voxels.GetWidth()) || transPos.y > float(m_pData->Voxels.GetHeight()) || transPos.z-FLT_EPSILON > float(m_pData->Voxels.GetDepth()));
 }
 
 	
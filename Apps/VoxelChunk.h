@@ -1,27 +1,180 @@
 #pragma once
 #include <Base/Array3D.h>
+#include <Base/BrickMap.h>
 #include <stdint.h>
 #include <DataHandling/Mesh.h>
 #include <glm/glm.hpp>
 #include <Base/Ray.h>
+#include <Base/OccupancyMask.h>
+#include <memory>
+
+enum class MeshingMode
+{
+	CulledFaces,	//One quad per exposed voxel face
+	Greedy			//Merges coplanar faces of the same material into larger quads
+};
+
+enum class VoxelVertexFormat
+{
+	Float,	//POSITION, COLOR, NORMAL in world space, 40 bytes per vertex
+	Packed	//Chunk local position + normal id as UBYTE4 and the material as UINT, 8 bytes per vertex
+};
+using FloatVoxelLayout = VertexLayoutT<VertexAttribute::POSITION, VertexAttribute::COLOR, VertexAttribute::NORMAL>;
+using PackedVoxelLayout = VertexLayoutT<VertexAttribute::UBYTE4, VertexAttribute::UINT>;
+
+//Edge length in voxels of the cubic sections a chunk is split in for incremental remeshing.
+const int VoxelSectionSize = 8;
+//Coarsest level of detail, a voxel of level n covers 2^n voxels of the chunk along every axis.
+const int MaxChunkLod = 3;
+
+//Slot of one section in the vertex and index arrays of a VoxelMesh. The capacity leaves room for the section to grow,
+//unused indices form degenerate triangles so the slot can be drawn as is.
+struct VoxelMeshSection
+{
+	size_t FirstVertex{};
+	size_t VertexCount{};
+	size_t VertexCapacity{};
+	size_t FirstIndex{};
+	size_t IndexCount{};
+	size_t IndexCapacity{};
+};
+
+//CPU side mesh of a chunk, filled by VoxelChunk::GenerateMesh. The arrays mirror the layout of the GPU buffers
+//so a remeshed section can be patched in place.
+struct VoxelMesh
+{
+	std::vector<float>				Vertices{};
+	std::vector<uint32_t>			PackedVertices{};
+	std::vector<uint32_t>			Indices{};
+	std::vector<VoxelMeshSection>	Sections{};
+	VoxelVertexFormat				Format{ VoxelVertexFormat::Float };
+	MeshingMode						Mode{ MeshingMode::CulledFaces };
+	int								Lod{ 0 };	//Packed positions are in voxels of this level, multiply by GetVoxelScale for chunk units
+
+	void Clear();
+	float GetVoxelScale() const { return float(1 << Lod); }
+	//Vertex data in whichever format the mesh was generated, including the unused room of every section.
+	const void* GetVertexData() const;
+	size_t GetVertexDataSize() const;
+	//Size of one vertex in bytes.
+	size_t GetVertexSize() const;
+	//Vertices and indices actually used by the sections.
+	size_t GetVertexCount() const;
+	size_t GetIndexCount() const;
+};
+
+struct VoxelHit
+{
+	glm::ivec3	VoxelId{};
+	glm::ivec3	Normal{};	//Outward normal of the face the ray entered through, zero when the ray starts inside the voxel
+	float		Distance{};	//Ray parameter where the voxel is entered, in units of the ray direction
+};
+
+//Voxels of a chunk and the occupancy mask built from them. Chunks with the same content share one instance
+//until one of them is edited, see VoxelWorld::ShareData.
+struct VoxelChunkData
+{
+	explicit VoxelChunkData(const BrickMap& voxels);
+	size_t GetMemorySize() const { return Voxels.GetMemorySize() + Occupancy.GetMemorySize(); }
+
+	BrickMap		Voxels;
+	OccupancyMask	Occupancy;
+};
+
+//Voxel data of the six chunks around a chunk in face order +X, -X, +Y, -Y, +Z, -Z. The mesher culls the faces on the chunk border
+//against the layer of the neighbour that touches it, sides without data keep their border faces.
+struct VoxelChunkNeighbours
+{
+	std::shared_ptr<VoxelChunkData> pData[6]{};
+};
+
+//Occupancy of the neighbour layers touching a chunk, at the level of detail being meshed, in the same face order. +X and -X hold
+//a column of z bits per y, +Y and -Y a column of z bits per x, +Z and -Z a row of y bits per x. Sides without a neighbour are empty.
+struct VoxelApron
+{
+	std::vector<uint64_t> Layers[6]{};
+};
+
 class VoxelChunk
 {
 public:
 	VoxelChunk(const Array3D<uint32_t>& data, const glm::vec3& position = {0,0,0});
+	VoxelChunk(const BrickMap& data, const glm::vec3& position = {0,0,0});
+	VoxelChunk(const std::shared_ptr<VoxelChunkData>& pData, const glm::vec3& position = {0,0,0});
 	const Mesh& GetMesh() const { return m_Mesh; }
-	void GenerateMesh();
-	Array3D<uint32_t>& GetData() { return m_VoxelData; };
-	bool Raycast(glm::ivec3& id, const Ray& ray, float minDist = 0, float maxDist = FLT_MAX);
-	const std::vector<float>& GetVertexBuffer() { return m_Vertices; }
-	const std::vector<uint32_t>& GetIndexBuffer() { return m_Indices; }
-	const glm::ivec3& GetVoxel(glm::vec3 position);
+	void GenerateMesh(MeshingMode mode = MeshingMode::CulledFaces, VoxelVertexFormat format = VoxelVertexFormat::Float, int lod = 0, const VoxelChunkNeighbours& neighbours = {});
+	//Only reads the chunk, so it can run on a worker thread as long as neither the chunk nor its neighbours are edited meanwhile.
+	//Levels above 0 mesh the voxels of CreateLodData with the same mesher and cull against the neighbours downsampled the same way.
+	//Only pass neighbours meshed at the same level, the border faces kept towards the others hide the gaps where a neighbour of
+	//another level has its surface a little higher or lower.
+	void GenerateMesh(VoxelMesh& mesh, MeshingMode mode, VoxelVertexFormat format, int lod = 0, const VoxelChunkNeighbours& neighbours = {}) const;
+	//Voxels downsampled by 2^lod along every axis. Every voxel takes the most common value of the 2x2x2 voxels it covers on the level
+	//below, ties go to the solid values so thin layers do not vanish.
+	std::shared_ptr<VoxelChunkData> CreateLodData(int lod) const;
+	const VoxelMesh& GetVoxelMesh() const { return m_VoxelMesh; }
+	void SetVoxelMesh(VoxelMesh&& mesh) { m_VoxelMesh = std::move(mesh); }
+	static std::vector<VertexAttribute> GetVertexAttributes(VoxelVertexFormat format);
+	//Read only, edits go through SetVoxelValue or SetData so the occupancy mask stays in sync.
+	const BrickMap& GetData() const { return m_pData->Voxels; };
+	//The data might be shared with other chunks, it is copied before the first edit.
+	const std::shared_ptr<VoxelChunkData>& GetSharedData() const { return m_pData; }
+	//Replaces every voxel and flags the chunk as modified, the whole mesh has to be generated again afterwards.
+	void SetData(const Array3D<uint32_t>& data);
+	void SetData(const BrickMap& data);
+	void SetData(const std::shared_ptr<VoxelChunkData>& pData);
+	uint32_t GetVoxelValue(const glm::ivec3& voxelId) const { return m_pData->Voxels.Get(voxelId); }
+	//Flags the chunk as modified when the value changes.
+	void SetVoxelValue(const glm::ivec3& voxelId, uint32_t value);
+	//True once the voxels were edited, until ClearModified is called after they were saved.
+	bool IsModified() const { return m_IsModified; }
+	void ClearModified() { m_IsModified = false; }
+	const OccupancyMask& GetOccupancy() const { return m_pData->Occupancy; }
+	bool IsEmpty() const { return m_pData->Occupancy.GetOccupiedCount() == 0; }
+	//Every voxel occupied, only the faces on the chunk border can be visible.
+	bool IsSolid() const { return m_pData->Occupancy.GetOccupiedCount() == m_pData->Voxels.GetWidth() * m_pData->Voxels.GetHeight() * m_pData->Voxels.GetDepth(); }
+	//Flags the sections whose mesh depends on the voxel. The id may lie one voxel outside the chunk so edits in a neighbouring chunk
+	//can flag the border sections of this one.
+	void MarkDirty(const glm::ivec3& voxelId);
+	bool HasDirtySections() const { return m_HasDirtySections; }
+	//Remeshes the dirty sections into their slots of the current mesh, keeping its mode, format and level of detail. The ids of the
+	//patched sections are added to updatedSections. Returns false when a section outgrew its slot or the mesh has a level above 0,
+	//then the whole mesh was generated again instead.
+	bool UpdateDirtySections(std::vector<size_t>& updatedSections, const VoxelChunkNeighbours& neighbours = {});
+	//Finds the first occupied voxel along the ray between minDist and maxDist.
+	bool Raycast(VoxelHit& hit, const Ray& ray, float minDist = 0, float maxDist = FLT_MAX) const;
+	const std::vector<float>& GetVertexBuffer() { return m_VoxelMesh.Vertices; }
+	const std::vector<uint32_t>& GetPackedVertexBuffer() { return m_VoxelMesh.PackedVertices; }
+	const std::vector<uint32_t>& GetIndexBuffer() { return m_VoxelMesh.Indices; }
+	const void* GetVertexData() const { return m_VoxelMesh.GetVertexData(); }
+	size_t GetVertexDataSize() const { return m_VoxelMesh.GetVertexDataSize(); }
+	VoxelVertexFormat GetVertexFormat() const { return m_VoxelMesh.Format; }
+	const glm::vec3& GetPosition() const { return m_Position; }
+	glm::ivec3 GetVoxel(glm::vec3 position) const;
 	bool IsInChunk(glm::vec3 pos) const;
 
 private:
-	Array3D<uint32_t> m_VoxelData;
+	//Lays the sections out with room to grow, WriteFace scales the faces by the level of detail of the mesh.
+	void GenerateSectionedMesh(VoxelMesh& mesh, MeshingMode mode, VoxelVertexFormat format, int lod, const VoxelApron& apron) const;
+	//Reads the neighbour layers touching this chunk, downsampled by 2^lod like CreateLodData.
+	VoxelApron CreateApron(const VoxelChunkNeighbours& neighbours, int lod) const;
+	//Like OccupancyMask::GetExposedFaces, but faces on the chunk border are culled against the apron.
+	uint64_t GetExposedFaces(int x, int y, size_t faceId, const VoxelApron& apron) const;
+	glm::ivec3 GetSectionCount() const;
+	size_t GetSectionId(const glm::ivec3& section) const;
+	void GenerateSectionMesh(VoxelMesh& mesh, size_t sectionId, const VoxelApron& apron) const;
+	//True when the section is a single brick of air, or of solid voxels with solid bricks on every side, so it has no faces.
+	bool IsSectionHidden(const glm::ivec3& section) const;
+	//Mesh the voxels in [min, max), pValues holds the decoded voxels of that region.
+	void GenerateCulledMesh(VoxelMesh& mesh, const glm::ivec3& min, const glm::ivec3& max, const uint32_t* pValues, const VoxelApron& apron) const;
+	void GenerateGreedyMesh(VoxelMesh& mesh, const glm::ivec3& min, const glm::ivec3& max, const uint32_t* pValues, const VoxelApron& apron) const;
+	void WriteFace(VoxelMesh& mesh, size_t faceId, const glm::ivec3& voxelId, uint32_t material, int width = 1, int height = 1) const;
+
+	std::shared_ptr<VoxelChunkData> m_pData;
 	Mesh m_Mesh;
-	std::vector<float> m_Vertices{};
-	std::vector<uint32_t> m_Indices{};
+	VoxelMesh m_VoxelMesh{};
+	std::vector<bool> m_DirtySections{};
+	bool m_HasDirtySections{ false };
+	bool m_IsModified{ false };
 	glm::vec3 m_Position{};
 };
 
@@ -11,7 +11,9 @@
 #include "VulkanWrapper/CommandPool.h"
 #include "VulkanWrapper/FrameBuffer.h"
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <unordered_set>
 #include "VulkanWrapper/DescriptorPool.h"
 #include "VulkanWrapper/DescriptorSet.h"
 #include "VulkanWrapper/DepthStencilBuffer.h"
@@ -28,31 +30,41 @@
 #include <Base/Array3D.h>
 #include <DebugUI/DebugShaderEditor.h>
 #include <DebugUI/Button.h>
+#include <Base/ThreadPool.h>
+#include <Apps/ChunkMesher.h>
+#include <Apps/ChunkStreamer.h>
+#include <Apps/ChunkStorage.h>
+#include <Apps/TerrainGenerator.h>
 
 const uint32_t ParticleCount = 100000;
+//Meshes uploaded per frame, the rest wait for the next frames so streaming in many chunks at once does not stall a frame.
+const size_t MaxMeshUploadsPerFrame = 8;
+//Built from PackedColorNormalPerspective.vert by Compile.bat.
+const char* const PackedTerrainVertexShader = "../Shaders/MeshDebugRendering/PackedColorNormalPerspective.vert.spv";
 
 VulkanApp::VulkanApp(vkw::VulkanDevice* pDevice)
 	:VulkanBaseApp(pDevice, "VoxelTest")
-	,m_pChunks{1, 1, 1}
 	,m_pVertexBuffers{}
 	,m_pIndexBuffers{}
 {
-	const size_t chunkSize = 16;
-	int width = m_pChunks.GetWidth();
-	int height = m_pChunks.GetHeight();
-	int depth = m_pChunks.GetDepth();
-	for (size_t x = 0; x < width; x++)
+	const int chunkSize = 16;
+	m_pWorld = new VoxelWorld(chunkSize);
+	m_pThreadPool = new ThreadPool();
+	m_pChunkMesher = new ChunkMesher(m_pThreadPool);
+	ChunkStreamingSettings streamingSettings{};
+	streamingSettings.LoadRadius = m_LoadRadius;
+	streamingSettings.UnloadRadius = m_LoadRadius + 2;
+	streamingSettings.LodRadius = m_LodRadius;
+	m_pTerrainGenerator = new TerrainGenerator();
+	const TerrainGenerator* pTerrainGenerator = m_pTerrainGenerator;
+	m_pChunkStreamer = new ChunkStreamer(m_pWorld, m_pThreadPool, [pTerrainGenerator](const glm::ivec3& chunkCoord, Array3D<uint32_t>& voxels)
 	{
-		for (size_t y = 0; y < height; y++)
-		{
-			for (size_t z = 0; z < depth; z++)
-			{
-				m_pChunks[x][y][z] = new VoxelChunk{ {chunkSize, chunkSize, chunkSize}, glm::vec3{x * chunkSize, y * chunkSize, z * chunkSize} };
-			}
-		}
-	}
-	m_pIndexBuffers.resize(width*height*depth);
-	m_pVertexBuffers.resize(width*height*depth);
+		pTerrainGenerator->Generate(chunkCoord, voxels);
+	}, streamingSettings);
+	m_pChunkStorage = new ChunkStorage("VoxelWorld_", chunkSize);
+	m_pChunkStreamer->SetStorage(m_pChunkStorage);
+	//Start above the surface instead of inside a hill.
+	m_Camera = Camera{ glm::vec3{ 0.f, m_pTerrainGenerator->GetSurfaceHeight(0.f, 0.f) + 16.f, 0.f } };
 }
 
 VulkanApp::~VulkanApp()
@@ -82,6 +94,11 @@ void VulkanApp::Render()
 
 	GetSwapchain()->PresentImage(m_pDebugUI->GetDebugRenderCompleteSemaphore());
 	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	if (m_IsEditPending)
+	{
+		m_EditLatency = std::chrono::duration<float>(t2 - m_EditStartTime).count() * 1000;
+		m_IsEditPending = false;
+	}
 	m_RenderTime = std::chrono::duration<float>(t2 - t1).count()*1000;
 	t1 = t2;
 
@@ -119,39 +136,36 @@ bool VulkanApp::Update(float dTime)
 	}
 	if(GetWindow()->IsMouseButtonPressed(MouseButton::RIGHT))
 	{
-		glm::ivec3 id;
+		VoxelHit hit;
+		size_t chunkId;
 		Ray ray{ m_Camera.GetPosition(), m_Camera.GetFront() };
-		for (size_t i = 0; i < m_pIndexBuffers.size(); i++)
+		if (m_pWorld->Raycast(hit, chunkId, ray, 0, 8.f))
 		{
-			if(m_pChunks.Data()[i]->Raycast(id, ray, 0, 8.f))
+			m_EditStartTime = std::chrono::steady_clock::now();
+			m_IsEditPending = true;
+			const glm::ivec3 worldVoxelId = hit.VoxelId + glm::ivec3(m_pWorld->GetChunk(chunkId)->GetPosition());
+			const int brushSize = 1;
+			for (int x = -brushSize; x < brushSize; x++)
 			{
-				const int brushSize = 1;
-				for (int x = -brushSize; x < brushSize; x++)
+				for (int y = -brushSize; y < brushSize; y++)
 				{
-					for (int y = -brushSize; y < brushSize; y++)
+					for (int z = -brushSize; z < brushSize; z++)
 					{
-						for (int z = -brushSize; z < brushSize; z++)
-						{
-							glm::ivec3 chunkSize = { m_pChunks.Data()[i]->GetData().GetWidth(), m_pChunks.Data()[i]->GetData().GetHeight(), m_pChunks.Data()[i]->GetData().GetDepth() };
-							glm::ivec3 voxelId{};
-							voxelId.x = glm::min(glm::max(id.x + x, 0), chunkSize.x);
-							voxelId.y = glm::min(glm::max(id.y + y, 0), chunkSize.y);
-							voxelId.z = glm::min(glm::max(id.z + z, 0), chunkSize.z);
-							m_pChunks.Data()[i]->GetData()[voxelId.x][voxelId.y][voxelId.z] = 0;
-						}
+						m_pWorld->SetVoxelValue(worldVoxelId + glm::ivec3{ x, y, z }, 0);
 					}
 				}
-				m_pChunks.Data()[i]->GenerateMesh();
-				delete m_pIndexBuffers[i];
-				delete m_pVertexBuffers[i];
-				std::vector<VertexAttribute> attributes = { VertexAttribute::POSITION, VertexAttribute::COLOR, VertexAttribute::NORMAL };
-				m_pIndexBuffers[i] = new vkw::IndexBuffer(GetDevice(), GetCommandPool(), m_pChunks.Data()[i]->GetIndexBuffer().size(), m_pChunks.Data()[i]->GetIndexBuffer().data());
-				m_pVertexBuffers[i] = new vkw::VertexBuffer(GetDevice(), GetCommandPool(), vkw::VertexLayout(attributes), m_pChunks.Data()[i]->GetVertexBuffer().size() * sizeof(float), m_pChunks.Data()[i]->GetVertexBuffer().data());
-				Reload();
-				break;
 			}
+			UpdateDirtyChunks();
 		}
 	}
+	const bool hasRemovedChunks = StreamChunks();
+	if (ApplyFinishedChunkMeshes() || hasRemovedChunks)
+	{
+		RebuildCommandBuffers();
+	}
+	m_PendingMeshCount = int(m_pChunkMesher->GetPendingCount());
+	m_ResidentChunkCount = int(m_pWorld->GetResidentChunkCount());
+	m_MissingChunkCount = int(m_pChunkStreamer->GetMissingCount() + m_pChunkStreamer->GetGeneratingCount());
 	UpdateUniformBuffers(dTime);
 	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
 	m_UpdateTime = std::chrono::duration<float>(t2 - t1).count()*1000;
@@ -164,15 +178,14 @@ void VulkanApp::Init(uint32_t width, uint32_t height)
 	//EnableRaytracingExtension();
 	VulkanBaseApp::Init(width, height);
 	m_pUniformBuffer = new vkw::Buffer(GetDevice(), GetCommandPool(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, size_t(sizeof(CameraInfo)), &m_Ubo);
-	CreateTerrainVertexBuffer();
 	CreateParticleBuffer();
 	m_pDescriptorPool = new vkw::DescriptorPool(GetDevice());
 	m_pNoInstanceDescriptorSet = new vkw::DescriptorSet();
 	m_pNoInstanceDescriptorSet->AddBinding(m_pUniformBuffer->GetDescriptor(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
 	m_pDescriptorPool->AddDescriptorSet(m_pNoInstanceDescriptorSet);
 	m_pDescriptorPool->Allocate();
-	m_pNoInstanceGraphicsPipeline = new vkw::GraphicsPipeline(GetDevice(), GetRenderPass(), GetPipelineCache(), m_pNoInstanceDescriptorSet->GetLayout(), m_pVertexBuffers[0]->GetLayout(), "../Shaders/MeshDebugRendering/ColorNormalPerspective.vert.spv", "../Shaders/MeshDebugRendering/Diffuse.frag.spv");
-	vkw::VertexLayout particleLayout{ {VertexAttribute::POSITION, VertexAttribute::FLOAT, VertexAttribute::VEC3, VertexAttribute::FLOAT} };
+	m_pNoInstanceGraphicsPipeline = new vkw::GraphicsPipeline(GetDevice(), GetRenderPass(), GetPipelineCache(), m_pNoInstanceDescriptorSet->GetLayout(), FloatVoxelLayout{}, "../Shaders/MeshDebugRendering/ColorNormalPerspective.vert.spv", "../Shaders/MeshDebugRendering/Diffuse.frag.spv");
+	vkw::VertexLayout particleLayout{ VertexLayoutT<VertexAttribute::POSITION, VertexAttribute::FLOAT, VertexAttribute::VEC3, VertexAttribute::FLOAT>{} };
 	m_pParticlePipeline = new vkw::GraphicsPipeline(GetDevice(), GetRenderPass(), GetPipelineCache(), m_pNoInstanceDescriptorSet->GetLayout(), particleLayout.GetLayout(), "../Shaders/Particles/Particle.vert.spv", "../Shaders/Particles/Particle.frag.spv", VK_PRIMITIVE_TOPOLOGY_POINT_LIST);
 	m_pDebugUI = new vkw::DebugUI(GetDevice(), GetCommandPool(), GetWindow(), GetSwapchain(), GetDepthStencilBuffer());
 	m_pDebugWindow = new vkw::DebugWindow{ "Properties" };
@@ -180,6 +193,14 @@ void VulkanApp::Init(uint32_t width, uint32_t height)
 	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_ShouldCaptureMouse), "Camera");
 	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_UseInstancing));
 	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_UseRaymarching));
+	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_UseGreedyMeshing), "Terrain");
+	//Packed vertices are only offered once their shader is compiled, loading a missing shader ends the app.
+	if (std::ifstream{ PackedTerrainVertexShader, std::ios::binary }.is_open())
+		m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_UsePackedVertices), "Terrain");
+	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_LoadRadius), "Terrain");
+	m_pDebugWindow->AddUIElement(UI_CREATEPARAMETER(m_LodRadius), "Terrain");
+	m_pDebugWindow->AddUIElement(new vkw::Button("Remesh Terrain", std::bind(&VulkanApp::RemeshTerrain, this)), "Terrain");
+	m_pDebugWindow->AddUIElement(new vkw::Button("Save Terrain", std::bind(&ChunkStreamer::SaveModifiedChunks, m_pChunkStreamer)), "Terrain");
 	m_pDebugWindow->AddUIElement(new vkw::ShaderEditor("../Shaders/Particles/Particle.vert"), "Shader");
 	std::function<void()> callBack = std::bind(&VulkanApp::Reload, this);
 	m_pDebugWindow->AddUIElement(new vkw::Button("Rebuild Pipeline", callBack), "Shader");
@@ -191,9 +212,18 @@ void VulkanApp::Init(uint32_t width, uint32_t height)
 void VulkanApp::Cleanup()
 {
 	ErrorCheck(vkQueueWaitIdle(GetDevice()->GetQueue()));
+	m_pChunkStreamer->SaveModifiedChunks();
+	//Joins the workers before the mesher, streamer, generator and storage they use go away.
+	delete m_pThreadPool;
+	delete m_pChunkMesher;
+	delete m_pChunkStreamer;
+	delete m_pTerrainGenerator;
+	//Writes the saved chunks before returning.
+	delete m_pChunkStorage;
 	delete m_pDebugWindow;
 	delete m_pDebugUI;
 	delete m_pNoInstanceGraphicsPipeline;
+	delete m_pPackedTerrainPipeline;
 	delete m_pParticlePipeline;
 	delete m_pParticleBuffer;
 	delete m_pDescriptorPool;
@@ -202,8 +232,8 @@ void VulkanApp::Cleanup()
 	{
 		delete m_pVertexBuffers[i];
 		delete m_pIndexBuffers[i];
-		delete m_pChunks.Data()[i];
 	}
+	delete m_pWorld;
 	VulkanBaseApp::Cleanup();
 }
 
@@ -214,22 +244,236 @@ void VulkanApp::EnableRaytracingExtension()
 	GetDevice()->EnableDeviceExtension(VK_NV_RAY_TRACING_EXTENSION_NAME);
 }
 
-void VulkanApp::CreateTerrainVertexBuffer()
+bool VulkanApp::StreamChunks()
+{
+	bool isLodValid = true;
+	if (m_LoadRadius != m_pChunkStreamer->GetSettings().LoadRadius && m_LoadRadius >= 0)
+	{
+		ChunkStreamingSettings settings = m_pChunkStreamer->GetSettings();
+		settings.UnloadRadius += m_LoadRadius - settings.LoadRadius;
+		settings.LoadRadius = m_LoadRadius;
+		m_pChunkStreamer->SetSettings(settings);
+	}
+	if (m_LodRadius != m_pChunkStreamer->GetSettings().LodRadius && m_LodRadius >= 0)
+	{
+		ChunkStreamingSettings settings = m_pChunkStreamer->GetSettings();
+		settings.LodRadius = m_LodRadius;
+		m_pChunkStreamer->SetSettings(settings);
+		isLodValid = false;
+	}
+	m_AddedChunks.clear();
+	m_RemovedChunks.clear();
+	m_pChunkStreamer->Update(m_Camera.GetPosition(), m_Camera.GetFront(), m_AddedChunks, m_RemovedChunks);
+	m_pIndexBuffers.resize(m_pWorld->GetChunkCount());
+	m_pVertexBuffers.resize(m_pWorld->GetChunkCount());
+	m_ChunkLods.resize(m_pWorld->GetChunkCount());
+
+	if (!m_RemovedChunks.empty())
+	{
+		//The buffers of removed chunks might still be in use by a frame in flight.
+		vkQueueWaitIdle(GetDevice()->GetQueue());
+		for (size_t chunkId : m_RemovedChunks)
+		{
+			m_pChunkMesher->Cancel(chunkId);
+			delete m_pIndexBuffers[chunkId];
+			delete m_pVertexBuffers[chunkId];
+			m_pIndexBuffers[chunkId] = nullptr;
+			m_pVertexBuffers[chunkId] = nullptr;
+		}
+	}
+	//The levels are updated before anything is submitted, so every chunk sees the new level of its neighbours.
+	std::vector<size_t> changedChunks(m_AddedChunks);
+	for (size_t chunkId : m_AddedChunks)
+	{
+		m_ChunkLods[chunkId] = m_pChunkStreamer->GetChunkLod(m_pWorld->GetChunkCoord(chunkId));
+	}
+	//Chunks that moved into another ring are meshed again, their old mesh is drawn until then.
+	if (!isLodValid || m_pChunkStreamer->GetCameraChunk() != m_LodCameraChunk)
+	{
+		m_LodCameraChunk = m_pChunkStreamer->GetCameraChunk();
+		for (size_t i = 0; i < m_pWorld->GetChunkCount(); i++)
+		{
+			if (!m_pWorld->GetChunk(i))
+				continue;
+			const int lod = m_pChunkStreamer->GetChunkLod(m_pWorld->GetChunkCoord(i));
+			if (m_ChunkLods[i] != lod)
+			{
+				m_ChunkLods[i] = lod;
+				changedChunks.push_back(i);
+			}
+		}
+	}
+	//The border faces of the neighbours are culled against the new or changed chunks. Removed chunks leave their neighbours as they
+	//are, the faces that would have to come back point away from the camera.
+	std::vector<size_t> remeshedChunks(changedChunks);
+	for (size_t chunkId : changedChunks)
+	{
+		for (size_t faceId = 0; faceId < 6; faceId++)
+		{
+			const size_t neighbourId = m_pWorld->GetNeighbourId(chunkId, faceId);
+			if (neighbourId != VoxelWorld::InvalidChunkId && !m_pWorld->GetChunk(neighbourId)->IsEmpty())
+				remeshedChunks.push_back(neighbourId);
+		}
+	}
+	std::sort(remeshedChunks.begin(), remeshedChunks.end());
+	remeshedChunks.erase(std::unique(remeshedChunks.begin(), remeshedChunks.end()), remeshedChunks.end());
+	for (size_t chunkId : remeshedChunks)
+	{
+		SubmitChunkMesh(chunkId);
+	}
+	return !m_RemovedChunks.empty();
+}
+
+void VulkanApp::SubmitChunkMesh(size_t chunkId)
 {
-	std::vector<VertexAttribute> attributes = { VertexAttribute::POSITION, VertexAttribute::COLOR, VertexAttribute::NORMAL };
+	VoxelVertexFormat vertexFormat = m_UsePackedVertices ? VoxelVertexFormat::Packed : VoxelVertexFormat::Float;
+	m_ChunkLods[chunkId] = m_pChunkStreamer->GetChunkLod(m_pWorld->GetChunkCoord(chunkId));
+	m_pChunkMesher->Submit(chunkId, *m_pWorld->GetChunk(chunkId), m_UseGreedyMeshing ? MeshingMode::Greedy : MeshingMode::CulledFaces, vertexFormat,
+		m_ChunkLods[chunkId], GetMeshNeighbours(chunkId));
+}
+
+VoxelChunkNeighbours VulkanApp::GetMeshNeighbours(size_t chunkId) const
+{
+	VoxelChunkNeighbours neighbours{};
+	for (size_t faceId = 0; faceId < 6; faceId++)
+	{
+		const size_t neighbourId = m_pWorld->GetNeighbourId(chunkId, faceId);
+		if (neighbourId != VoxelWorld::InvalidChunkId && m_ChunkLods[neighbourId] == m_ChunkLods[chunkId])
+			neighbours.pData[faceId] = m_pWorld->GetChunk(neighbourId)->GetSharedData();
+	}
+	return neighbours;
+}
+
+void VulkanApp::UploadChunkMesh(size_t chunkId)
+{
+	VoxelChunk* pChunk = m_pWorld->GetChunk(chunkId);
+	delete m_pIndexBuffers[chunkId];
+	delete m_pVertexBuffers[chunkId];
+	m_pIndexBuffers[chunkId] = nullptr;
+	m_pVertexBuffers[chunkId] = nullptr;
+	//Vulkan does not allow empty buffers, chunks without faces are simply not drawn.
+	if (pChunk->GetIndexBuffer().empty())
+		return;
+	//Indices address the whole vertex array including the unused room of the sections, which patching never resizes.
+	const VoxelMesh& mesh = pChunk->GetVoxelMesh();
+	m_pIndexBuffers[chunkId] = new vkw::IndexBuffer(GetDevice(), GetCommandPool(), mesh.Indices.size(), mesh.Indices.data(), mesh.GetVertexDataSize() / mesh.GetVertexSize());
+	m_pVertexBuffers[chunkId] = new vkw::VertexBuffer(GetDevice(), GetCommandPool(), (pChunk->GetVertexFormat() == VoxelVertexFormat::Packed ? vkw::VertexLayout(PackedVoxelLayout{}) : vkw::VertexLayout(FloatVoxelLayout{})), pChunk->GetVertexDataSize(), pChunk->GetVertexData());
+}
+
+bool VulkanApp::ApplyFinishedChunkMeshes()
+{
+	std::vector<ChunkMeshResult> results;
+	m_pChunkMesher->PopResults(results, MaxMeshUploadsPerFrame);
+	if (results.empty())
+		return false;
+
+	//The old buffers might still be in use by a frame in flight.
+	vkQueueWaitIdle(GetDevice()->GetQueue());
+	for (ChunkMeshResult& result : results)
+	{
+		m_pWorld->GetChunk(result.ChunkId)->SetVoxelMesh(std::move(result.Mesh));
+		UploadChunkMesh(result.ChunkId);
+		m_MeshingTime = result.MeshingTime;
+	}
+	UpdateTerrainStats();
+	return true;
+}
+
+void VulkanApp::UpdateTerrainStats()
+{
+	m_TriangleCount = 0;
+	size_t vertexMemory = 0;
 	for (size_t i = 0; i < m_pIndexBuffers.size(); i++)
 	{
-		const size_t chunkSize = m_pChunks.Data()[i]->GetData().GetWidth() * m_pChunks.Data()[i]->GetData().GetHeight() * m_pChunks.Data()[i]->GetData().GetDepth();
-		for (size_t j = 0; j < chunkSize; j++)
+		if (!m_pIndexBuffers[i])
+			continue;
+		m_TriangleCount += int(m_pWorld->GetChunk(i)->GetVoxelMesh().GetIndexCount() / 3);
+		vertexMemory += m_pWorld->GetChunk(i)->GetVertexDataSize();
+	}
+	m_VertexMemoryMB = vertexMemory / (1024.f * 1024.f);
+
+	//Memory the sparse palette storage and the sharing of identical chunks save per chunk compared to a dense uint32_t array.
+	const size_t residentCount = m_pWorld->GetResidentChunkCount();
+	if (residentCount == 0)
+		return;
+	const size_t chunkSize = m_pWorld->GetChunkSize();
+	const size_t denseSize = residentCount * chunkSize * chunkSize * chunkSize * sizeof(uint32_t);
+	std::unordered_set<const VoxelChunkData*> countedData{};
+	size_t voxelMemory = 0;
+	for (size_t i = 0; i < m_pWorld->GetChunkCount(); i++)
+	{
+		if (!m_pWorld->GetChunk(i))
+			continue;
+		const VoxelChunkData* pData = m_pWorld->GetChunk(i)->GetSharedData().get();
+		if (countedData.insert(pData).second)
+			voxelMemory += pData->GetMemorySize();
+	}
+	m_VoxelMemorySavedKB = (float(denseSize) - float(voxelMemory)) / (1024.f * residentCount);
+}
+
+void VulkanApp::UpdateDirtyChunks()
+{
+	//Patched buffers might still be read by a frame in flight.
+	vkQueueWaitIdle(GetDevice()->GetQueue());
+	bool hasNewBuffers = false;
+	std::vector<size_t> updatedSections;
+	for (size_t i = 0; i < m_pIndexBuffers.size(); i++)
+	{
+		VoxelChunk* pChunk = m_pWorld->GetChunk(i);
+		if (!pChunk || !pChunk->HasDirtySections())
+			continue;
+
+		//A mesh generated from older data would undo the edit once it arrives, so generate it again.
+		if (m_pChunkMesher->IsPending(i))
+			SubmitChunkMesh(i);
+
+		updatedSections.clear();
+		if (pChunk->UpdateDirtySections(updatedSections, GetMeshNeighbours(i)) && m_pIndexBuffers[i])
 		{
-			m_pChunks.Data()[i]->GetData().Data()[j] = 1;
+			PatchChunkSections(i, updatedSections);
 		}
+		else
+		{
+			UploadChunkMesh(i);
+			hasNewBuffers = true;
+		}
+	}
+	UpdateTerrainStats();
+	if (hasNewBuffers)
+		RebuildCommandBuffers();
+}
 
-		m_pChunks.Data()[i]->GenerateMesh();
-		m_pIndexBuffers[i] = new vkw::IndexBuffer(GetDevice(), GetCommandPool(), m_pChunks.Data()[i]->GetIndexBuffer().size(), m_pChunks.Data()[i]->GetIndexBuffer().data());
-		m_pVertexBuffers[i] = new vkw::VertexBuffer(GetDevice(), GetCommandPool(), vkw::VertexLayout(attributes), m_pChunks.Data()[i]->GetVertexBuffer().size()*sizeof(float), m_pChunks.Data()[i]->GetVertexBuffer().data());
+void VulkanApp::PatchChunkSections(size_t chunkId, const std::vector<size_t>& sectionIds)
+{
+	const VoxelMesh& mesh = m_pWorld->GetChunk(chunkId)->GetVoxelMesh();
+	const VkDeviceSize vertexSize = mesh.GetVertexSize();
+	std::vector<VkBufferCopy> vertexRegions;
+	std::vector<VkBufferCopy> indexRegions;
+	for (size_t sectionId : sectionIds)
+	{
+		const VoxelMeshSection& section = mesh.Sections[sectionId];
+		//Vertices past VertexCount are no longer referenced, the whole index slot is rewritten since the padding moved.
+		if (section.VertexCount > 0)
+			vertexRegions.push_back({ section.FirstVertex * vertexSize, section.FirstVertex * vertexSize, section.VertexCount * vertexSize });
+		if (section.IndexCapacity > 0)
+			indexRegions.push_back({ section.FirstIndex, section.FirstIndex, section.IndexCapacity });
 	}
-	
+	m_pVertexBuffers[chunkId]->GetBuffer().Update(mesh.GetVertexData(), vertexRegions, GetCommandPool());
+	m_pIndexBuffers[chunkId]->Update(mesh.Indices.data(), indexRegions, GetCommandPool());
+}
+
+void VulkanApp::RemeshTerrain()
+{
+	for (size_t i = 0; i < m_pIndexBuffers.size(); i++)
+	{
+		if (m_pWorld->GetChunk(i))
+			SubmitChunkMesh(i);
+	}
+}
+
+void VulkanApp::CreatePackedTerrainPipeline()
+{
+	m_pPackedTerrainPipeline = new vkw::GraphicsPipeline(GetDevice(), GetRenderPass(), GetPipelineCache(), m_pNoInstanceDescriptorSet->GetLayout(), PackedVoxelLayout{}, PackedTerrainVertexShader, "../Shaders/MeshDebugRendering/Diffuse.frag.spv", VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FRONT_FACE_CLOCKWISE, false, uint32_t(sizeof(glm::vec4)));
 }
 
 void VulkanApp::CreateParticleBuffer()
@@ -313,14 +557,31 @@ void VulkanApp::BuildDrawCommandBuffers()
 
 		vkCmdSetScissor(m_DrawCommandBuffers[i], 0, 1, &scissor);
 
-		vkCmdBindDescriptorSets(m_DrawCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pNoInstanceGraphicsPipeline->GetLayout(), 0, 1, &m_pNoInstanceDescriptorSet->GetHandle(), 0, NULL);
-
 		VkDeviceSize offsets[1] = { 0 };
-		vkCmdBindPipeline(m_DrawCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pNoInstanceGraphicsPipeline->GetPipeline());
+		vkw::GraphicsPipeline* pBoundPipeline = nullptr;
 		for (size_t j = 0; j < m_pIndexBuffers.size(); j++)
 		{
+			//Chunks remeshed with a different vertex format keep drawing until the next RemeshTerrain, so pick the pipeline per chunk.
+			if (!m_pIndexBuffers[j])
+				continue;
+			const VoxelChunk* pChunk = m_pWorld->GetChunk(j);
+			const bool isPacked = pChunk->GetVertexFormat() == VoxelVertexFormat::Packed;
+			if (isPacked && !m_pPackedTerrainPipeline)
+				CreatePackedTerrainPipeline();
+			vkw::GraphicsPipeline* pPipeline = isPacked ? m_pPackedTerrainPipeline : m_pNoInstanceGraphicsPipeline;
+			if (pPipeline != pBoundPipeline)
+			{
+				vkCmdBindDescriptorSets(m_DrawCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->GetLayout(), 0, 1, &m_pNoInstanceDescriptorSet->GetHandle(), 0, NULL);
+				vkCmdBindPipeline(m_DrawCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->GetPipeline());
+				pBoundPipeline = pPipeline;
+			}
+			if (isPacked)
+			{
+				glm::vec4 chunkPosition{ pChunk->GetPosition(), pChunk->GetVoxelMesh().GetVoxelScale() };
+				vkCmdPushConstants(m_DrawCommandBuffers[i], pPipeline->GetLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::vec4), &chunkPosition);
+			}
 			vkCmdBindVertexBuffers(m_DrawCommandBuffers[i], 0, 1, &m_pVertexBuffers[j]->GetBuffer().GetHandle(), offsets);
-			vkCmdBindIndexBuffer(m_DrawCommandBuffers[i], m_pIndexBuffers[j]->GetBuffer().GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(m_DrawCommandBuffers[i], m_pIndexBuffers[j]->GetBuffer().GetHandle(), 0, m_pIndexBuffers[j]->GetIndexType());
 			vkCmdDrawIndexed(m_DrawCommandBuffers[i], uint32_t(m_pIndexBuffers[j]->GetIndexCount()), 1, 0, 0, 1);
 		}
 
@@ -351,11 +612,21 @@ void VulkanApp::Reload()
 	vkQueueWaitIdle(GetDevice()->GetQueue());
 	FreeDrawCommandBuffers();
 	m_pNoInstanceGraphicsPipeline->Rebuild();
+	if (m_pPackedTerrainPipeline)
+		m_pPackedTerrainPipeline->Rebuild();
 	m_pParticlePipeline->Rebuild();
 	AllocateDrawCommandBuffers();
 	BuildDrawCommandBuffers();
 }
 
+void VulkanApp::RebuildCommandBuffers()
+{
+	vkQueueWaitIdle(GetDevice()->GetQueue());
+	FreeDrawCommandBuffers();
+	AllocateDrawCommandBuffers();
+	BuildDrawCommandBuffers();
+}
+
 void VulkanApp::InitDebugStatWindow()
 {
 	m_pDebugStatWindow = new vkw::DebugWindow{ "Statistics" };
@@ -363,6 +634,14 @@ void VulkanApp::InitDebugStatWindow()
 	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_Framerate));
 	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_RenderTime));
 	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_UpdateTime));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_MeshingTime));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_PendingMeshCount));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_ResidentChunkCount));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_MissingChunkCount));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_EditLatency));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_TriangleCount));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_VertexMemoryMB));
+	m_pDebugStatWindow->AddUIElement(UI_CREATESTAT(m_VoxelMemorySavedKB));
 }
 
 
@@ -4,8 +4,10 @@
 #include <array>
 #include "Base/Camera.h"
 #include "Apps/VoxelChunk.h"
+#include "Apps/VoxelWorld.h"
 #include <Base/Array3D.h>
 #include <random>
+#include <chrono>
 
 namespace vkw {
 	class Buffer;
@@ -21,6 +23,11 @@ namespace vkw {
 }
 
 class Mesh;
+class ThreadPool;
+class ChunkMesher;
+class ChunkStreamer;
+class ChunkStorage;
+class TerrainGenerator;
 
 class VulkanApp : vkw::VulkanBaseApp
 {
@@ -37,10 +44,24 @@ protected:
 	void FreeDrawCommandBuffers() override;
 private:
 	void EnableRaytracingExtension();
-	void CreateTerrainVertexBuffer();
+	//Loads and unloads the chunks around the camera, returns true if any chunk was removed.
+	bool StreamChunks();
+	void SubmitChunkMesh(size_t chunkId);
+	//Neighbours the chunk mesh is culled against, only those meshed at the same level of detail.
+	VoxelChunkNeighbours GetMeshNeighbours(size_t chunkId) const;
+	void UploadChunkMesh(size_t chunkId);
+	//Swaps in the meshes finished by the workers, returns true if any chunk changed.
+	bool ApplyFinishedChunkMeshes();
+	void UpdateTerrainStats();
+	//Remeshes the dirty sections of every chunk and patches them into the GPU buffers.
+	void UpdateDirtyChunks();
+	void PatchChunkSections(size_t chunkId, const std::vector<size_t>& sectionIds);
+	void RemeshTerrain();
+	void CreatePackedTerrainPipeline();
 	void CreateParticleBuffer();
 	void UpdateUniformBuffers(float dTime);
 	void Reload();
+	void RebuildCommandBuffers();
 	
 
 
@@ -49,6 +70,7 @@ private:
 
 
 	vkw::GraphicsPipeline*			m_pNoInstanceGraphicsPipeline = nullptr;
+	vkw::GraphicsPipeline*			m_pPackedTerrainPipeline = nullptr;
 	vkw::GraphicsPipeline*			m_pParticlePipeline = nullptr;
 	vkw::ComputePipeline*			m_pComputePipeline = nullptr;
 
@@ -60,7 +82,17 @@ private:
 	std::vector<vkw::VertexBuffer*>	m_pVertexBuffers;
 	vkw::Buffer*					m_pTerrainDataBuffer = nullptr;
 	vkw::Buffer*					m_pParticleBuffer = nullptr;
-	Array3D<VoxelChunk*>			m_pChunks;
+	VoxelWorld*						m_pWorld = nullptr;
+	ThreadPool*						m_pThreadPool = nullptr;
+	ChunkMesher*					m_pChunkMesher = nullptr;
+	ChunkStreamer*					m_pChunkStreamer = nullptr;
+	ChunkStorage*					m_pChunkStorage = nullptr;
+	TerrainGenerator*				m_pTerrainGenerator = nullptr;
+	std::vector<size_t>				m_AddedChunks{};
+	std::vector<size_t>				m_RemovedChunks{};
+	//Level of detail each chunk was last submitted for meshing with.
+	std::vector<int>				m_ChunkLods{};
+	glm::ivec3						m_LodCameraChunk{};
 
 	struct CameraInfo
 	{
@@ -81,7 +113,7 @@ private:
 	vkw::DebugWindow*				m_pDebugWindow = nullptr;
 	//Camera
 	glm::vec2						m_PrevMousePos{};
-	Camera							m_Camera{};
+	Camera							m_Camera{ glm::vec3{ 0.f, 40.f, 0.f } };
 	float							m_ElapsedSec{};
 	float							m_CameraSpeed = 20.f;
 	bool							m_ShouldCaptureMouse = true;
@@ -89,6 +121,10 @@ private:
 	//Game
 	bool							m_UseInstancing = false;
 	bool							m_UseRaymarching = false;
+	bool							m_UseGreedyMeshing = true;
+	bool							m_UsePackedVertices = false;
+	int								m_LoadRadius = 6;
+	int								m_LodRadius = 4;
 
 	//Stats
 	void InitDebugStatWindow();
@@ -98,6 +134,16 @@ private:
 	float							m_UpdateTime{};
 	float							m_Framerate{};
 	float							m_FPS{};
+	float							m_MeshingTime{};
+	int								m_PendingMeshCount{};
+	int								m_ResidentChunkCount{};
+	int								m_MissingChunkCount{};
+	float							m_EditLatency{};
+	std::chrono::steady_clock::time_point	m_EditStartTime{};
+	bool							m_IsEditPending{ false };
+	int								m_TriangleCount{};
+	float							m_VertexMemoryMB{};
+	float							m_VoxelMemorySavedKB{};
 
 
 	public:
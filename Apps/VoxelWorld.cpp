@@ -0,0 +1,260 @@
+#include "VoxelWorld.h"
+#include <Base/GridTraversal.h>
+#include <Base/ThreadPool.h>
+#include <algorithm>
+#include <climits>
+
+const size_t VoxelWorld::InvalidChunkId;
+
+VoxelWorld::VoxelWorld(int chunkSize)
+	:m_ChunkSize{ chunkSize }
+{
+}
+
+VoxelWorld::VoxelWorld(const glm::ivec3& chunkCount, int chunkSize)
+	:m_ChunkSize{ chunkSize }
+{
+	//Every chunk starts out referencing the same empty data.
+	const BrickMap emptyData{ size_t(chunkSize), size_t(chunkSize), size_t(chunkSize) };
+	m_pChunks.reserve(size_t(chunkCount.x) * chunkCount.y * chunkCount.z);
+	ResizeChunkGrid(glm::ivec3{ 0 }, chunkCount);
+	for (int x = 0; x < chunkCount.x; x++)
+	{
+		for (int y = 0; y < chunkCount.y; y++)
+		{
+			for (int z = 0; z < chunkCount.z; z++)
+			{
+				AddChunk({ x, y, z }, emptyData);
+			}
+		}
+	}
+}
+
+VoxelWorld::~VoxelWorld()
+{
+	for (VoxelChunk* pChunk : m_pChunks)
+	{
+		delete pChunk;
+	}
+}
+
+VoxelChunk* VoxelWorld::GetChunk(const glm::ivec3& chunkCoord) const
+{
+	const size_t chunkId = GetChunkId(chunkCoord);
+	return chunkId == InvalidChunkId ? nullptr : m_pChunks[chunkId];
+}
+
+size_t VoxelWorld::GetChunkId(const glm::ivec3& chunkCoord) const
+{
+	const glm::ivec3 gridCoord = chunkCoord - m_ChunkGridMin;
+	if (gridCoord.x < 0 || gridCoord.y < 0 || gridCoord.z < 0
+		|| size_t(gridCoord.x) >= m_ChunkGrid.GetWidth() || size_t(gridCoord.y) >= m_ChunkGrid.GetHeight() || size_t(gridCoord.z) >= m_ChunkGrid.GetDepth())
+		return InvalidChunkId;
+	return m_ChunkGrid.at(gridCoord.x, gridCoord.y, gridCoord.z);
+}
+
+size_t VoxelWorld::AddChunk(const glm::ivec3& chunkCoord, const BrickMap& data)
+{
+	assert(GetChunkId(chunkCoord) == InvalidChunkId && "Chunk is already resident!");
+	size_t chunkId = m_pChunks.size();
+	if (!m_FreeChunkIds.empty())
+	{
+		chunkId = m_FreeChunkIds.back();
+		m_FreeChunkIds.pop_back();
+	}
+	else
+	{
+		m_pChunks.push_back(nullptr);
+	}
+	m_pChunks[chunkId] = new VoxelChunk{ ShareData(data), glm::vec3(chunkCoord * m_ChunkSize) };
+	if (m_ResidentChunkCount == 0)
+	{
+		m_MinChunk = chunkCoord;
+		m_MaxChunk = chunkCoord + 1;
+	}
+	else
+	{
+		m_MinChunk = glm::min(m_MinChunk, chunkCoord);
+		m_MaxChunk = glm::max(m_MaxChunk, chunkCoord + 1);
+	}
+	m_ResidentChunkCount++;
+
+	const glm::ivec3 gridCoord = chunkCoord - m_ChunkGridMin;
+	if (glm::any(glm::lessThan(gridCoord, glm::ivec3(0)))
+		|| glm::any(glm::greaterThanEqual(gridCoord, glm::ivec3(m_ChunkGrid.GetWidth(), m_ChunkGrid.GetHeight(), m_ChunkGrid.GetDepth()))))
+		ResizeChunkGrid(m_MinChunk, m_MaxChunk);
+	else
+		m_ChunkGrid[gridCoord.x][gridCoord.y][gridCoord.z] = chunkId;
+	return chunkId;
+}
+
+void VoxelWorld::RemoveChunk(size_t chunkId)
+{
+	const glm::ivec3 chunkCoord = GetChunkCoord(chunkId);
+	const glm::ivec3 gridCoord = chunkCoord - m_ChunkGridMin;
+	m_ChunkGrid[gridCoord.x][gridCoord.y][gridCoord.z] = InvalidChunkId;
+	m_ResidentChunkCount--;
+	delete m_pChunks[chunkId];
+	m_pChunks[chunkId] = nullptr;
+	m_FreeChunkIds.push_back(chunkId);
+	if (glm::any(glm::equal(chunkCoord, m_MinChunk)) || glm::any(glm::equal(chunkCoord + 1, m_MaxChunk)))
+		UpdateChunkBounds();
+}
+
+void VoxelWorld::UpdateChunkBounds()
+{
+	m_MinChunk = glm::ivec3{ INT_MAX };
+	m_MaxChunk = glm::ivec3{ INT_MIN };
+	for (size_t i = 0; i < m_pChunks.size(); i++)
+	{
+		if (!m_pChunks[i])
+			continue;
+		const glm::ivec3 chunkCoord = GetChunkCoord(i);
+		m_MinChunk = glm::min(m_MinChunk, chunkCoord);
+		m_MaxChunk = glm::max(m_MaxChunk, chunkCoord + 1);
+	}
+	if (m_ResidentChunkCount == 0)
+		m_MinChunk = m_MaxChunk = {};
+}
+
+void VoxelWorld::ResizeChunkGrid(const glm::ivec3& minChunk, const glm::ivec3& maxChunk)
+{
+	const int margin = 4;
+	m_ChunkGridMin = minChunk - margin;
+	const glm::ivec3 gridSize = maxChunk - minChunk + 2 * margin;
+	m_ChunkGrid = Array3D<size_t>{ size_t(gridSize.x), size_t(gridSize.y), size_t(gridSize.z) };
+	m_ChunkGrid.Fill(InvalidChunkId);
+	for (size_t i = 0; i < m_pChunks.size(); i++)
+	{
+		if (!m_pChunks[i])
+			continue;
+		const glm::ivec3 gridCoord = GetChunkCoord(i) - m_ChunkGridMin;
+		m_ChunkGrid[gridCoord.x][gridCoord.y][gridCoord.z] = i;
+	}
+}
+
+std::shared_ptr<VoxelChunkData> VoxelWorld::ShareData(const BrickMap& data)
+{
+	const uint64_t hash = data.GetHash();
+	auto range = m_SharedData.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		//Compare the voxels as well, a hash collision or an edit since the data was added must not merge different chunks.
+		std::shared_ptr<VoxelChunkData> pData = it->second.lock();
+		if (pData && pData->Voxels == data)
+			return pData;
+	}
+
+	//Drop the entries of data no chunk uses anymore whenever the table doubled since the last sweep.
+	if (m_SharedData.size() >= 2 * m_SharedDataSweepSize)
+	{
+		for (auto it = m_SharedData.begin(); it != m_SharedData.end();)
+		{
+			it = it->second.expired() ? m_SharedData.erase(it) : std::next(it);
+		}
+		m_SharedDataSweepSize = std::max(m_SharedData.size(), size_t(64));
+	}
+	std::shared_ptr<VoxelChunkData> pData = std::make_shared<VoxelChunkData>(data);
+	m_SharedData.emplace(hash, pData);
+	return pData;
+}
+
+void VoxelWorld::SetChunkData(size_t chunkId, const BrickMap& data)
+{
+	GetChunk(chunkId)->SetData(ShareData(data));
+}
+
+glm::ivec3 VoxelWorld::GetChunkCoord(const glm::ivec3& worldVoxelId) const
+{
+	//Round towards negative infinity so voxels left of the origin land in chunk -1.
+	return glm::ivec3(glm::floor(glm::vec3(worldVoxelId) / float(m_ChunkSize)));
+}
+
+bool VoxelWorld::SetVoxelValue(const glm::ivec3& worldVoxelId, uint32_t value)
+{
+	const glm::ivec3 chunkCoord = GetChunkCoord(worldVoxelId);
+	VoxelChunk* pChunk = GetChunk(chunkCoord);
+	if (!pChunk)
+		return false;
+	pChunk->SetVoxelValue(worldVoxelId - chunkCoord * m_ChunkSize, value);
+	MarkVoxelDirty(worldVoxelId);
+	return true;
+}
+
+size_t VoxelWorld::GetNeighbourId(size_t chunkId, size_t faceId) const
+{
+	const glm::ivec3 neighbours[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	return GetChunkId(GetChunkCoord(chunkId) + neighbours[faceId]);
+}
+
+void VoxelWorld::MarkVoxelDirty(const glm::ivec3& worldVoxelId)
+{
+	//Only the chunks holding the voxel or one of its direct neighbours depend on it.
+	const glm::ivec3 minChunk = GetChunkCoord(worldVoxelId - 1);
+	const glm::ivec3 maxChunk = GetChunkCoord(worldVoxelId + 1);
+	for (int x = minChunk.x; x <= maxChunk.x; x++)
+	{
+		for (int y = minChunk.y; y <= maxChunk.y; y++)
+		{
+			for (int z = minChunk.z; z <= maxChunk.z; z++)
+			{
+				const glm::ivec3 chunkCoord{ x, y, z };
+				VoxelChunk* pChunk = GetChunk(chunkCoord);
+				if (pChunk)
+					pChunk->MarkDirty(worldVoxelId - chunkCoord * m_ChunkSize);
+			}
+		}
+	}
+}
+
+bool VoxelWorld::Raycast(VoxelHit& hit, size_t& chunkId, const Ray& ray, float minDist, float maxDist) const
+{
+	if (m_ResidentChunkCount == 0)
+		return false;
+	GridTraversal traversal{};
+	if (!traversal.Init(ray, glm::vec3(m_MinChunk * m_ChunkSize), m_MaxChunk - m_MinChunk, float(m_ChunkSize), minDist, maxDist))
+		return false;
+	do
+	{
+		const size_t id = GetChunkId(traversal.GetCell() + m_MinChunk);
+		if (id == InvalidChunkId)
+			continue;
+		const VoxelChunk* pChunk = m_pChunks[id];
+		if (pChunk->IsEmpty())
+			continue;
+		//A solid chunk is hit right where the ray enters it, its voxels do not have to be walked.
+		if (pChunk->IsSolid())
+		{
+			hit.Distance = traversal.GetEnterDistance();
+			hit.Normal = traversal.GetNormal();
+			hit.VoxelId = pChunk->GetVoxel(ray.Traverse(hit.Distance));
+			chunkId = id;
+			return true;
+		}
+		//Chunks are visited front to back, so the first hit is the nearest one.
+		if (pChunk->Raycast(hit, ray, traversal.GetEnterDistance(), traversal.GetExitDistance()))
+		{
+			//The chunk starts its walk where the ray enters it and can not tell through which face, so a hit in the
+			//first voxel gets the normal of the chunk face.
+			if (hit.Normal == glm::ivec3(0))
+				hit.Normal = traversal.GetNormal();
+			chunkId = id;
+			return true;
+		}
+	} while (traversal.Step());
+	return false;
+}
+
+void VoxelWorld::RaycastBatch(ThreadPool& threadPool, const Ray* pRays, const float* pMaxDistances, size_t rayCount, VoxelRayResult* pResults) const
+{
+	//Big enough ranges that queueing a job costs little next to the rays it traces.
+	const size_t raysPerJob = 256;
+	threadPool.ParallelFor(rayCount, raysPerJob, [=](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			VoxelRayResult& result = pResults[i];
+			result.IsHit = Raycast(result.Hit, result.ChunkId, pRays[i], 0, pMaxDistances[i]);
+		}
+	});
+}
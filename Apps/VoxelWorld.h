@@ -0,0 +1,102 @@
+#pragma once
+#include "VoxelChunk.h"
+#include <Base/Array3D.h>
+#include <Base/Ray.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+struct ChunkCoordHash
+{
+	size_t operator()(const glm::ivec3& chunkCoord) const
+	{
+		return size_t(chunkCoord.x) * 73856093u ^ size_t(chunkCoord.y) * 19349663u ^ size_t(chunkCoord.z) * 83492791u;
+	}
+};
+
+struct VoxelRayResult
+{
+	bool		IsHit{ false };
+	size_t		ChunkId{};
+	VoxelHit	Hit{};
+};
+
+//Sparse set of equally sized cubic chunks found by their integer chunk coordinate, chunk (0, 0, 0) starts at the world origin.
+//Owns the chunks. Chunk ids are slots that stay the same while the chunk is resident and are reused after it is removed.
+class VoxelWorld
+{
+public:
+	static const size_t InvalidChunkId = ~size_t(0);
+
+	//Empty world, chunks are added with AddChunk.
+	explicit VoxelWorld(int chunkSize);
+	//Fills the grid [0, chunkCount) with empty chunks, with ids in x, y, z order.
+	VoxelWorld(const glm::ivec3& chunkCount, int chunkSize);
+	~VoxelWorld();
+	VoxelWorld(const VoxelWorld&) = delete;
+	VoxelWorld& operator=(const VoxelWorld&) = delete;
+
+	//Upper bound of the chunk ids. Slots of removed chunks return nullptr until they are reused.
+	size_t GetChunkCount() const { return m_pChunks.size(); }
+	size_t GetResidentChunkCount() const { return m_ResidentChunkCount; }
+	VoxelChunk* GetChunk(size_t chunkId) const { return m_pChunks[chunkId]; }
+	//Returns nullptr when the chunk is not resident.
+	VoxelChunk* GetChunk(const glm::ivec3& chunkCoord) const;
+	//Returns InvalidChunkId when the chunk is not resident.
+	size_t GetChunkId(const glm::ivec3& chunkCoord) const;
+	glm::ivec3 GetChunkCoord(size_t chunkId) const { return glm::ivec3(m_pChunks[chunkId]->GetPosition()) / m_ChunkSize; }
+	//Id of the chunk next to the given one in the direction of the face, in the face order of VoxelChunkNeighbours.
+	//Returns InvalidChunkId when that chunk is not resident.
+	size_t GetNeighbourId(size_t chunkId, size_t faceId) const;
+	int GetChunkSize() const { return m_ChunkSize; }
+
+	//Makes the chunk resident with the given voxels, shared with identical chunks. The chunk must not be resident yet.
+	size_t AddChunk(const glm::ivec3& chunkCoord, const BrickMap& data);
+	//Deletes the chunk and frees its id for the next AddChunk.
+	void RemoveChunk(size_t chunkId);
+
+	//Returns data holding the given voxels, shared with every chunk whose content is identical. Chunks copy shared data
+	//before their first edit, so sharing is invisible to them.
+	std::shared_ptr<VoxelChunkData> ShareData(const BrickMap& data);
+	//Replaces the voxels of a chunk, sharing them with identical chunks.
+	void SetChunkData(size_t chunkId, const BrickMap& data);
+
+	//Sets the voxel and flags the chunk sections that have to be remeshed. Returns false when its chunk is not resident.
+	bool SetVoxelValue(const glm::ivec3& worldVoxelId, uint32_t value);
+	//Flags the sections of every chunk whose mesh depends on the voxel.
+	void MarkVoxelDirty(const glm::ivec3& worldVoxelId);
+
+	//Nearest occupied voxel along the ray, hit.VoxelId is local to the chunk. Walks the chunk grid spanned by the resident chunks and only
+	//traverses the voxels of chunks that are not empty, so the cost follows the distance travelled instead of the world size.
+	//Chunks that are not resident count as empty.
+	bool Raycast(VoxelHit& hit, size_t& chunkId, const Ray& ray, float minDist = 0, float maxDist = FLT_MAX) const;
+
+	//Raycasts every ray up to its max distance on the thread pool and writes the result to the same index in pResults.
+	//Blocks until all rays are done and does not allocate per ray.
+	void RaycastBatch(ThreadPool& threadPool, const Ray* pRays, const float* pMaxDistances, size_t rayCount, VoxelRayResult* pResults) const;
+
+private:
+	glm::ivec3 GetChunkCoord(const glm::ivec3& worldVoxelId) const;
+	//Recomputes the box around the resident chunks after one on its border was removed.
+	void UpdateChunkBounds();
+	//Refits the id grid to [minChunk, maxChunk) plus a margin, so a world that moves along with the camera only refits every few chunks.
+	void ResizeChunkGrid(const glm::ivec3& minChunk, const glm::ivec3& maxChunk);
+
+	std::vector<VoxelChunk*>	m_pChunks{};
+	std::vector<size_t>		m_FreeChunkIds{};
+	size_t					m_ResidentChunkCount{};
+	//Chunk ids by coordinate over a box around the resident chunks. Dense instead of a hash map since Raycast looks up every chunk
+	//it passes.
+	Array3D<size_t>			m_ChunkGrid{ 0, 0, 0 };
+	glm::ivec3				m_ChunkGridMin{};
+	//Box around the resident chunks, max is exclusive.
+	glm::ivec3				m_MinChunk{};
+	glm::ivec3				m_MaxChunk{};
+	int						m_ChunkSize{};
+	//Content hash to the data handed out by ShareData. Only weak references, the chunks own the data.
+	std::unordered_multimap<uint64_t, std::weak_ptr<VoxelChunkData>>	m_SharedData{};
+	size_t					m_SharedDataSweepSize{ 64 };
+};
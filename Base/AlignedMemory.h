@@ -0,0 +1,109 @@
+#pragma once
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+//Cache line alignment for bulk data, so rows start on a line and SIMD loads never split one.
+const size_t CacheLineSize = 64;
+
+inline void* AlignedAllocate(size_t size, size_t alignment = CacheLineSize)
+{
+	if (size == 0)
+		return nullptr;
+#ifdef _MSC_VER
+	void* pMemory = _aligned_malloc(size, alignment);
+#else
+	void* pMemory = nullptr;
+	if (posix_memalign(&pMemory, alignment, size) != 0)
+		pMemory = nullptr;
+#endif
+	if (!pMemory)
+		throw std::bad_alloc{};
+	return pMemory;
+}
+
+inline void AlignedFree(void* pMemory)
+{
+#ifdef _MSC_VER
+	_aligned_free(pMemory);
+#else
+	free(pMemory);
+#endif
+}
+
+template<class T>
+void ConstructElements(T* pData, size_t count, std::true_type /*isTrivial*/)
+{
+	memset(pData, 0, count * sizeof(T));
+}
+
+template<class T>
+void ConstructElements(T* pData, size_t count, std::false_type /*isTrivial*/)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		new (pData + i) T();
+	}
+}
+
+template<class T>
+void CopyConstructElements(T* pData, const T* pSource, size_t count, std::true_type /*isTrivial*/)
+{
+	memcpy(pData, pSource, count * sizeof(T));
+}
+
+template<class T>
+void CopyConstructElements(T* pData, const T* pSource, size_t count, std::false_type /*isTrivial*/)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		new (pData + i) T(pSource[i]);
+	}
+}
+
+template<class T>
+void DestroyElements(T* /*pData*/, size_t /*count*/, std::true_type /*isTrivial*/)
+{
+}
+
+template<class T>
+void DestroyElements(T* pData, size_t count, std::false_type /*isTrivial*/)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		pData[i].~T();
+	}
+}
+
+//Allocates count elements of T on a cache line. Trivial types are zeroed with a single memset instead of being constructed one by one.
+template<class T>
+T* AlignedNew(size_t count)
+{
+	T* pData = static_cast<T*>(AlignedAllocate(count * sizeof(T)));
+	if (pData)
+		ConstructElements(pData, count, std::integral_constant<bool, std::is_trivially_default_constructible<T>::value>{});
+	return pData;
+}
+
+template<class T>
+T* AlignedNewCopy(const T* pSource, size_t count)
+{
+	T* pData = static_cast<T*>(AlignedAllocate(count * sizeof(T)));
+	if (pData)
+		CopyConstructElements(pData, pSource, count, std::integral_constant<bool, std::is_trivially_copyable<T>::value>{});
+	return pData;
+}
+
+template<class T>
+void AlignedDelete(T* pData, size_t count)
+{
+	if (!pData)
+		return;
+	DestroyElements(pData, count, std::integral_constant<bool, std::is_trivially_destructible<T>::value>{});
+	AlignedFree(pData);
+}
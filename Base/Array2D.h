@@ -1,6 +1,9 @@
 #pragma once
+#include "AlignedMemory.h"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 
 //Struct that allows you to handle data as a 2D array (Does not take ownership)
@@ -24,7 +27,7 @@ struct IArray2D
 };
 
 
-//Class that wraps the Array interface to handle ownership of the data.
+//Class that wraps the Array interface to handle ownership of the data. Storage is aligned to a cache line.
 template<class T>
 class Array2D {
 private:
@@ -35,7 +38,7 @@ public:
 	{
 		m_Interface.Width = width;
 		m_Interface.Height = height;
-		m_Interface.pData = new T[width * height];;
+		m_Interface.pData = AlignedNew<T>(width * height);
 	}
 
 	//copy constructor
@@ -47,39 +50,33 @@ public:
 	//assignment operator
 	Array2D& operator=(Array2D const& other)
 	{
-		m_Interface.Width = other.m_Interface.Width;
-		m_Interface.Height = other.m_Interface.Height;
-		delete[] m_Interface.pData;
-		m_Interface.pData = new T[m_Height * m_Width];
-		memcpy(m_Interface.pData, other.m_Interface.pData, other.m_Interface.Height * other.m_Interface.Width * sizeof(T));
+		if (this == &other)
+			return *this;
+		//Copy before freeing, so a failed allocation leaves this array untouched.
+		IArray2D<T> copy = other.m_Interface;
+		copy.pData = AlignedNewCopy(other.m_Interface.pData, copy.Width * copy.Height);
+		std::swap(m_Interface, copy);
+		AlignedDelete(copy.pData, copy.Width * copy.Height);
 		return *this;
 	}
 
-	//move constructor
+	//move constructor, takes over the memory of other and leaves it empty
 	Array2D(Array2D&& other) noexcept
+		:m_Interface{ other.m_Interface }
 	{
-		*this = other;
+		other.m_Interface = {};
 	}
 
-	//move operator
+	//move operator, swaps so the old memory is freed along with other
 	Array2D& operator=(Array2D&& other) noexcept
 	{
-		size_t height = other.m_Interface.Width;
-		size_t width = other.m_Interface.Height;
-		T* pData = other.m_Interface.pData;
-		other.m_Interface.Width = m_Interface.Width;
-		other.m_Interface.Height = m_Interface.Height;
-		other.m_Interface.pData = m_Interface.pData;
-		m_Interface.Width = height;
-		m_Interface.Height = width;
-		m_Interface.pData = pData;
+		std::swap(m_Interface, other.m_Interface);
 		return *this;
 	}
 
 
 	~Array2D() {
-		if (m_Interface.pData)
-			delete[] m_Interface.pData;
+		AlignedDelete(m_Interface.pData, m_Interface.Width * m_Interface.Height);
 	}
 
 	T& at(size_t x, size_t y) {
@@ -88,9 +85,18 @@ public:
 
 	T* operator[](size_t x)
 	{
-		return &m_Interface[x];
+		return m_Interface[x];
 	}
 
+	void Fill(const T& value)
+	{
+		std::fill_n(m_Interface.pData, m_Interface.Width * m_Interface.Height, value);
+	}
+
+	//raw pointer to the memory
+	T* Data() { return m_Interface.pData; }
+	const T* Data() const { return m_Interface.pData; }
+
 	size_t GetWidth() const { return m_Interface.Height; }
 	size_t GetHeight() const { return m_Interface.Width; }
 
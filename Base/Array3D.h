@@ -1,11 +1,13 @@
 #pragma once
 #include "Array2D.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 
-//Struct that allows you to handle data as a 2D array (Does not take ownership)
+//Struct that allows you to handle data as a 3D array (Does not take ownership)
 template<class T>
 struct IArray3D
 {
@@ -15,8 +17,59 @@ struct IArray3D
 	size_t Depth{};
 
 	T& at(size_t x, size_t y, size_t z) {
-		assert(x*Height*Depth + y*Depth + z< Height * Width && "Requesting element out of array bounds!");
-		return pData[x*Height*Depth + y*Depth + z];
+		assert(x < Width && y < Height && z < Depth && "Requesting element out of array bounds!");
+		return pData[x * Height * Depth + y * Depth + z];
+	}
+
+	const T& at(size_t x, size_t y, size_t z) const {
+		assert(x < Width && y < Height && z < Depth && "Requesting element out of array bounds!");
+		return pData[x * Height * Depth + y * Depth + z];
+	}
+
+	//Visits the elements in memory order, z is contiguous and x is the slowest axis.
+	template<class Function>
+	void ForEach(Function function)
+	{
+		ForEach(0, Width, function);
+	}
+
+	template<class Function>
+	void ForEach(Function function) const
+	{
+		ForEach(0, Width, function);
+	}
+
+	//Only the x slices in [firstX, lastX), which never share elements.
+	template<class Function>
+	void ForEach(size_t firstX, size_t lastX, Function function)
+	{
+		T* pValue = pData + firstX * Height * Depth;
+		for (size_t x = firstX; x < lastX; x++)
+		{
+			for (size_t y = 0; y < Height; y++)
+			{
+				for (size_t z = 0; z < Depth; z++)
+				{
+					function(x, y, z, *pValue++);
+				}
+			}
+		}
+	}
+
+	template<class Function>
+	void ForEach(size_t firstX, size_t lastX, Function function) const
+	{
+		const T* pValue = pData + firstX * Height * Depth;
+		for (size_t x = firstX; x < lastX; x++)
+		{
+			for (size_t y = 0; y < Height; y++)
+			{
+				for (size_t z = 0; z < Depth; z++)
+				{
+					function(x, y, z, *pValue++);
+				}
+			}
+		}
 	}
 
 	IArray2D<T> operator[](size_t x)
@@ -31,7 +84,7 @@ struct IArray3D
 };
 
 
-//Class that wraps the Array interface to handle ownership of the data.
+//Class that wraps the Array interface to handle ownership of the data. Storage is aligned to a cache line.
 template<class T>
 class Array3D {
 private:
@@ -43,11 +96,7 @@ public:
 		m_Interface.Width = width;
 		m_Interface.Height = height;
 		m_Interface.Depth = depth;
-		m_Interface.pData = new T[width * height * depth];
-		for (size_t i = 0; i < width*height*depth; i++)
-		{
-			m_Interface.pData[i] = T();
-		}
+		m_Interface.pData = AlignedNew<T>(GetSize());
 	}
 
 	//copy constructor
@@ -59,59 +108,95 @@ public:
 	//assignment operator
 	Array3D& operator=(Array3D const& other)
 	{
-		m_Interface.Width = other.m_Interface.Width;
-		m_Interface.Height = other.m_Interface.Height;
-		m_Interface.Depth = other.m_Interface.Depth;
-		delete[] m_Interface.pData;
-		m_Interface.pData = new T[m_Interface.Height * m_Interface.Width * m_Interface.Depth];
-		memcpy(m_Interface.pData, other.m_Interface.pData, m_Interface.Height * m_Interface.Width * m_Interface.Depth * sizeof(T));
+		if (this == &other)
+			return *this;
+		//Copy before freeing, so a failed allocation leaves this array untouched.
+		IArray3D<T> copy = other.m_Interface;
+		copy.pData = AlignedNewCopy(other.m_Interface.pData, other.GetSize());
+		std::swap(m_Interface, copy);
+		AlignedDelete(copy.pData, copy.Width * copy.Height * copy.Depth);
 		return *this;
 	}
 
-	//move constructor
+	//move constructor, takes over the memory of other and leaves it empty
 	Array3D(Array3D&& other) noexcept
+		:m_Interface{ other.m_Interface }
 	{
-		*this = other;
+		other.m_Interface = {};
 	}
 
-	//move operator
+	//move operator, swaps so the old memory is freed along with other
 	Array3D& operator=(Array3D&& other) noexcept
 	{
-		size_t height = other.m_Interface.Width;
-		size_t width = other.m_Interface.Height;
-		size_t depth = other.m_Interface.Depth;
-		T* pData = other.m_Interface.pData;
-		other.m_Interface.Width = m_Interface.Width;
-		other.m_Interface.Height = m_Interface.Height;
-		other.m_Interface.Depth = m_Interface.Depth;
-		other.m_Interface.pData = m_Interface.pData;
-		m_Interface.Width = height;
-		m_Interface.Height = width;
-		
-		m_Interface.pData = pData;
+		std::swap(m_Interface, other.m_Interface);
 		return *this;
 	}
 
 
 	~Array3D() {
-		if (m_Interface.pData)
-			delete[] m_Interface.pData;
+		AlignedDelete(m_Interface.pData, GetSize());
 	}
 
 	T& at(size_t x, size_t y, size_t z) {
 		return m_Interface.at(x, y, z);
 	}
 
+	const T& at(size_t x, size_t y, size_t z) const {
+		return m_Interface.at(x, y, z);
+	}
+
 	IArray2D<T> operator[](size_t x)
 	{
 		return m_Interface[x];
 	}
 
+	//Calls function(x, y, z, element) for every element in memory order.
+	template<class Function>
+	void ForEach(Function function) { m_Interface.ForEach(function); }
+	template<class Function>
+	void ForEach(Function function) const { m_Interface.ForEach(function); }
+
+	//Like ForEach, but the x slices are spread over the thread pool. function must be safe to call concurrently
+	//for different elements. Blocks until every element is visited. Takes any pool with the interface of ThreadPool, so this
+	//header does not pull in the threading headers.
+	template<class Pool, class Function>
+	void ForEachParallel(Pool& threadPool, Function function)
+	{
+		const size_t slicesPerJob = std::max(size_t(1), m_Interface.Width / (threadPool.GetThreadCount() * 4));
+		threadPool.ParallelFor(m_Interface.Width, slicesPerJob, [this, &function](size_t begin, size_t end) { m_Interface.ForEach(begin, end, function); });
+	}
+
+	void Fill(const T& value)
+	{
+		std::fill_n(m_Interface.pData, GetSize(), value);
+	}
+
+	//Copies the box of the given size starting at sourceMin in source to destinationMin in this array.
+	void CopyRegion(const Array3D& source, size_t sourceX, size_t sourceY, size_t sourceZ,
+		size_t destinationX, size_t destinationY, size_t destinationZ, size_t width, size_t height, size_t depth)
+	{
+		assert(sourceX + width <= source.GetWidth() && sourceY + height <= source.GetHeight() && sourceZ + depth <= source.GetDepth() && "Region out of source bounds!");
+		assert(destinationX + width <= GetWidth() && destinationY + height <= GetHeight() && destinationZ + depth <= GetDepth() && "Region out of destination bounds!");
+		//An empty region may start at the far edge, where even the first row is out of bounds.
+		if (width == 0 || height == 0 || depth == 0)
+			return;
+		//z rows are contiguous on both sides.
+		for (size_t x = 0; x < width; x++)
+		{
+			for (size_t y = 0; y < height; y++)
+			{
+				std::copy_n(&source.at(sourceX + x, sourceY + y, sourceZ), depth, &at(destinationX + x, destinationY + y, destinationZ));
+			}
+		}
+	}
+
 	//raw pointer to the memory
 	T* Data() { return m_Interface.pData; }
+	const T* Data() const { return m_Interface.pData; }
 
 	size_t GetWidth() const { return m_Interface.Width; }
 	size_t GetHeight() const { return m_Interface.Height; }
 	size_t GetDepth() const { return m_Interface.Depth; }
+	size_t GetSize() const { return m_Interface.Width * m_Interface.Height * m_Interface.Depth; }
 
 };
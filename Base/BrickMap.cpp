@@ -0,0 +1,456 @@
+#include "BrickMap.h"
+#include <algorithm>
+
+BrickMap::BrickMap(size_t width, size_t height, size_t depth, uint32_t value)
+	:m_BrickCount{ (glm::ivec3{ width, height, depth } + BrickSize - 1) / BrickSize }
+	,m_Width{width}
+	,m_Height{height}
+	,m_Depth{depth}
+{
+	m_Bricks.resize(size_t(m_BrickCount.x) * m_BrickCount.y * m_BrickCount.z);
+	Fill(value);
+}
+
+BrickMap::BrickMap(const Array3D<uint32_t>& data)
+	:BrickMap(data.GetWidth(), data.GetHeight(), data.GetDepth())
+{
+	Build(data);
+}
+
+void BrickMap::Set(const glm::ivec3& voxelId, uint32_t value)
+{
+	assert(voxelId.x >= 0 && voxelId.y >= 0 && voxelId.z >= 0 && size_t(voxelId.x) < m_Width && size_t(voxelId.y) < m_Height && size_t(voxelId.z) < m_Depth && "Voxel out of brick map bounds!");
+	const glm::ivec3 brickId = voxelId >> BrickShift;
+	Brick& brick = m_Bricks[GetBrickId(brickId.x, brickId.y, brickId.z)];
+	if (brick.BlockId == UniformBrick)
+	{
+		if (brick.Value == value)
+			return;
+		SplitBrick(brick);
+	}
+
+	const int voxelOffset = GetVoxelOffset(voxelId.x, voxelId.y, voxelId.z);
+	if (!(brick.BlockId & RawBrick))
+	{
+		const uint32_t paletteId = GetPaletteId(value);
+		if (paletteId != NoPaletteId)
+			WriteIndex(brick.BlockId, voxelOffset, paletteId);
+		else
+			MakeRawBrick(brick);
+	}
+	if (brick.BlockId & RawBrick)
+		GetRawValues(brick)[voxelOffset] = value;
+
+	if (!IsBrickFilled(brick, brickId, value))
+		return;
+	brick.Value = value;
+	CollapseBrick(brick);
+}
+
+void BrickMap::Fill(uint32_t value)
+{
+	for (Brick& brick : m_Bricks)
+	{
+		brick.Value = value;
+		brick.BlockId = UniformBrick;
+	}
+	m_Indices.clear();
+	m_FreeBlocks.clear();
+	m_RawValues.clear();
+	m_FreeRawBlocks.clear();
+	m_Palette.clear();
+	m_PaletteIds.clear();
+	m_IndexBits = 1;
+	m_IndexMask = 1;
+	m_BlockCount = 0;
+	m_DenseBrickCount = 0;
+}
+
+void BrickMap::Build(const Array3D<uint32_t>& data)
+{
+	assert(data.GetWidth() == m_Width && data.GetHeight() == m_Height && data.GetDepth() == m_Depth && "Data does not match the brick map dimensions!");
+	Fill(0);
+	const glm::ivec3 size{ m_Width, m_Height, m_Depth };
+	for (int bx = 0; bx < m_BrickCount.x; bx++)
+	{
+		for (int by = 0; by < m_BrickCount.y; by++)
+		{
+			for (int bz = 0; bz < m_BrickCount.z; bz++)
+			{
+				const glm::ivec3 min = glm::ivec3{ bx, by, bz } * BrickSize;
+				const glm::ivec3 max = glm::min(min + BrickSize, size);
+				Brick& brick = m_Bricks[GetBrickId(bx, by, bz)];
+				brick.Value = data.at(min.x, min.y, min.z);
+
+				bool isUniform = true;
+				for (int x = min.x; x < max.x && isUniform; x++)
+				{
+					for (int y = min.y; y < max.y && isUniform; y++)
+					{
+						const uint32_t* pRow = &data.at(x, y, min.z);
+						isUniform = std::all_of(pRow, pRow + (max.z - min.z), [&brick](uint32_t value) { return value == brick.Value; });
+					}
+				}
+				if (isUniform)
+					continue;
+
+				SplitBrick(brick);
+				//Neighbouring voxels mostly repeat, so only look up the palette when the value changes.
+				uint32_t prevValue = brick.Value;
+				uint32_t paletteId = brick.BlockId & RawBrick ? NoPaletteId : GetPaletteId(prevValue);
+				for (int x = min.x; x < max.x; x++)
+				{
+					for (int y = min.y; y < max.y; y++)
+					{
+						for (int z = min.z; z < max.z; z++)
+						{
+							const uint32_t value = data.at(x, y, z);
+							if (value != prevValue && !(brick.BlockId & RawBrick))
+							{
+								prevValue = value;
+								paletteId = GetPaletteId(value);
+								if (paletteId == NoPaletteId)
+									MakeRawBrick(brick);
+							}
+							if (brick.BlockId & RawBrick)
+								GetRawValues(brick)[GetVoxelOffset(x, y, z)] = value;
+							else
+								WriteIndex(brick.BlockId, GetVoxelOffset(x, y, z), paletteId);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void BrickMap::Read(const glm::ivec3& min, const glm::ivec3& max, uint32_t* pValues) const
+{
+	assert(glm::all(glm::greaterThanEqual(min, glm::ivec3(0))) && glm::all(glm::lessThanEqual(max, glm::ivec3{ m_Width, m_Height, m_Depth })) && "Region out of brick map bounds!");
+	const glm::ivec3 size = max - min;
+	//Walk brick by brick so each brick is looked up once and uniform bricks become plain fills.
+	const glm::ivec3 minBrick = min >> BrickShift;
+	const glm::ivec3 maxBrick = (max + BrickSize - 1) >> BrickShift;
+	for (int bx = minBrick.x; bx < maxBrick.x; bx++)
+	{
+		for (int by = minBrick.y; by < maxBrick.y; by++)
+		{
+			for (int bz = minBrick.z; bz < maxBrick.z; bz++)
+			{
+				const Brick& brick = m_Bricks[GetBrickId(bx, by, bz)];
+				const glm::ivec3 brickMin = glm::max(glm::ivec3{ bx, by, bz } * BrickSize, min);
+				const glm::ivec3 brickMax = glm::min(glm::ivec3{ bx + 1, by + 1, bz + 1 } * BrickSize, max);
+				const int rowLength = brickMax.z - brickMin.z;
+				for (int x = brickMin.x; x < brickMax.x; x++)
+				{
+					for (int y = brickMin.y; y < brickMax.y; y++)
+					{
+						uint32_t* pRow = pValues + (size_t(x - min.x) * size.y + (y - min.y)) * size.z + (brickMin.z - min.z);
+						if (brick.BlockId == UniformBrick)
+						{
+							std::fill_n(pRow, rowLength, brick.Value);
+							continue;
+						}
+						if (brick.BlockId & RawBrick)
+						{
+							std::copy_n(GetRawValues(brick) + GetVoxelOffset(x, y, brickMin.z), rowLength, pRow);
+							continue;
+						}
+						//The z row of a brick is contiguous, so it is unpacked from at most a few words.
+						const size_t bitOffset = (size_t(brick.BlockId) * BrickVoxelCount + GetVoxelOffset(x, y, brickMin.z)) * m_IndexBits;
+						const uint32_t* pWords = &m_Indices[bitOffset >> 5];
+						uint32_t shift = uint32_t(bitOffset & 31);
+						for (int z = 0; z < rowLength; z++)
+						{
+							pRow[z] = m_Palette[(*pWords >> shift) & m_IndexMask];
+							shift += m_IndexBits;
+							if (shift == 32)
+							{
+								shift = 0;
+								pWords++;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void BrickMap::CopyTo(Array3D<uint32_t>& data) const
+{
+	assert(data.GetWidth() == m_Width && data.GetHeight() == m_Height && data.GetDepth() == m_Depth && "Data does not match the brick map dimensions!");
+	Read({ 0, 0, 0 }, { m_Width, m_Height, m_Depth }, data.Data());
+}
+
+bool BrickMap::IsUniform(uint32_t& value) const
+{
+	if (m_DenseBrickCount != 0)
+		return false;
+	value = m_Bricks[0].Value;
+	for (const Brick& brick : m_Bricks)
+	{
+		if (brick.Value != value)
+			return false;
+	}
+	return true;
+}
+
+//FNV-1a over 32 bit words.
+uint64_t HashValue(uint64_t hash, uint32_t value)
+{
+	const uint64_t prime = 1099511628211ull;
+	return (hash ^ value) * prime;
+}
+
+uint64_t BrickMap::GetHash() const
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash = HashValue(hash, uint32_t(m_Width));
+	hash = HashValue(hash, uint32_t(m_Height));
+	hash = HashValue(hash, uint32_t(m_Depth));
+	uint32_t values[BrickVoxelCount];
+	for (int bx = 0; bx < m_BrickCount.x; bx++)
+	{
+		for (int by = 0; by < m_BrickCount.y; by++)
+		{
+			for (int bz = 0; bz < m_BrickCount.z; bz++)
+			{
+				const Brick& brick = m_Bricks[GetBrickId(bx, by, bz)];
+				if (brick.BlockId == UniformBrick)
+				{
+					//A dense brick holding a single value can not exist, so the tag keeps uniform and dense bricks apart.
+					hash = HashValue(HashValue(hash, 0), brick.Value);
+					continue;
+				}
+				const glm::ivec3 min = glm::ivec3{ bx, by, bz } * BrickSize;
+				const glm::ivec3 max = glm::min(min + BrickSize, glm::ivec3{ m_Width, m_Height, m_Depth });
+				const glm::ivec3 size = max - min;
+				Read(min, max, values);
+				hash = HashValue(hash, 1);
+				for (int i = 0; i < size.x * size.y * size.z; i++)
+				{
+					hash = HashValue(hash, values[i]);
+				}
+			}
+		}
+	}
+	return hash;
+}
+
+bool BrickMap::operator==(const BrickMap& other) const
+{
+	if (m_Width != other.m_Width || m_Height != other.m_Height || m_Depth != other.m_Depth)
+		return false;
+	uint32_t values[BrickVoxelCount];
+	uint32_t otherValues[BrickVoxelCount];
+	for (int bx = 0; bx < m_BrickCount.x; bx++)
+	{
+		for (int by = 0; by < m_BrickCount.y; by++)
+		{
+			for (int bz = 0; bz < m_BrickCount.z; bz++)
+			{
+				const size_t brickId = GetBrickId(bx, by, bz);
+				const Brick& brick = m_Bricks[brickId];
+				const Brick& otherBrick = other.m_Bricks[brickId];
+				//Bricks collapse as soon as they are uniform, so a uniform brick never equals a dense one.
+				if ((brick.BlockId == UniformBrick) != (otherBrick.BlockId == UniformBrick))
+					return false;
+				if (brick.BlockId == UniformBrick)
+				{
+					if (brick.Value != otherBrick.Value)
+						return false;
+					continue;
+				}
+				const glm::ivec3 min = glm::ivec3{ bx, by, bz } * BrickSize;
+				const glm::ivec3 max = glm::min(min + BrickSize, glm::ivec3{ m_Width, m_Height, m_Depth });
+				const glm::ivec3 size = max - min;
+				Read(min, max, values);
+				other.Read(min, max, otherValues);
+				if (!std::equal(values, values + size.x * size.y * size.z, otherValues))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+size_t BrickMap::GetMemorySize() const
+{
+	//The hash map cost is estimated as one node per entry plus its bucket array.
+	const size_t paletteIdsSize = m_PaletteIds.size() * (2 * sizeof(uint32_t) + sizeof(void*)) + m_PaletteIds.bucket_count() * sizeof(void*);
+	const size_t rawSize = (m_RawValues.capacity() + m_FreeRawBlocks.capacity()) * sizeof(uint32_t);
+	return m_Bricks.capacity() * sizeof(Brick) + (m_Indices.capacity() + m_FreeBlocks.capacity() + m_Palette.capacity()) * sizeof(uint32_t) + paletteIdsSize + rawSize;
+}
+
+void BrickMap::WriteIndex(uint32_t blockId, int voxelOffset, uint32_t paletteId)
+{
+	const size_t bitOffset = size_t(blockId) * BrickVoxelCount * m_IndexBits + size_t(voxelOffset) * m_IndexBits;
+	uint32_t& word = m_Indices[bitOffset >> 5];
+	const uint32_t shift = uint32_t(bitOffset & 31);
+	word = (word & ~(m_IndexMask << shift)) | (paletteId << shift);
+}
+
+uint32_t BrickMap::GetPaletteId(uint32_t value)
+{
+	auto it = m_PaletteIds.find(value);
+	if (it != m_PaletteIds.end())
+		return it->second;
+
+	if (m_Palette.size() > m_IndexMask)
+	{
+		CompactPalette();
+		//Widen anyway when compacting freed only a few ids, otherwise every new value would compact again.
+		if (m_Palette.size() > m_IndexMask - m_IndexMask / 4 && m_IndexBits < MaxIndexBits)
+			WidenIndices(m_IndexBits * 2);
+		if (m_Palette.size() > m_IndexMask)
+			return NoPaletteId;
+	}
+	const uint32_t paletteId = uint32_t(m_Palette.size());
+	m_Palette.push_back(value);
+	m_PaletteIds.emplace(value, paletteId);
+	return paletteId;
+}
+
+void BrickMap::CompactPalette()
+{
+	//The padding of border bricks counts as well, it still has to decode when a brick becomes raw.
+	std::vector<uint32_t> newIds(m_Palette.size(), NoPaletteId);
+	for (const Brick& brick : m_Bricks)
+	{
+		if (brick.BlockId & RawBrick)
+			continue;
+		for (int i = 0; i < BrickVoxelCount; i++)
+		{
+			newIds[ReadIndex(brick.BlockId, i)] = 0;
+		}
+	}
+
+	std::vector<uint32_t> palette;
+	m_PaletteIds.clear();
+	for (size_t i = 0; i < m_Palette.size(); i++)
+	{
+		if (newIds[i] == NoPaletteId)
+			continue;
+		newIds[i] = uint32_t(palette.size());
+		m_PaletteIds.emplace(m_Palette[i], newIds[i]);
+		palette.push_back(m_Palette[i]);
+	}
+	m_Palette = std::move(palette);
+
+	for (const Brick& brick : m_Bricks)
+	{
+		if (brick.BlockId & RawBrick)
+			continue;
+		for (int i = 0; i < BrickVoxelCount; i++)
+		{
+			WriteIndex(brick.BlockId, i, newIds[ReadIndex(brick.BlockId, i)]);
+		}
+	}
+}
+
+void BrickMap::WidenIndices(int indexBits)
+{
+	assert(indexBits <= MaxIndexBits && "Brick map indices can not grow beyond 16 bits!");
+	std::vector<uint32_t> oldIndices = std::move(m_Indices);
+	const int oldIndexBits = m_IndexBits;
+	const uint32_t oldIndexMask = m_IndexMask;
+	m_IndexBits = indexBits;
+	m_IndexMask = (uint32_t(1) << indexBits) - 1;
+	m_Indices.assign(m_BlockCount * GetBlockWordCount(), 0);
+	const size_t indexCount = m_BlockCount * BrickVoxelCount;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const size_t oldBitOffset = i * oldIndexBits;
+		const uint32_t paletteId = (oldIndices[oldBitOffset >> 5] >> (oldBitOffset & 31)) & oldIndexMask;
+		const size_t bitOffset = i * m_IndexBits;
+		m_Indices[bitOffset >> 5] |= paletteId << (bitOffset & 31);
+	}
+}
+
+void BrickMap::SplitBrick(Brick& brick)
+{
+	assert(brick.BlockId == UniformBrick && "Brick is already split!");
+	m_DenseBrickCount++;
+	const uint32_t paletteId = GetPaletteId(brick.Value);
+	if (paletteId == NoPaletteId)
+	{
+		brick.BlockId = AllocateRawBlock() | RawBrick;
+		std::fill_n(GetRawValues(brick), BrickVoxelCount, brick.Value);
+		return;
+	}
+	if (m_FreeBlocks.empty())
+	{
+		brick.BlockId = uint32_t(m_BlockCount++);
+		m_Indices.resize(m_BlockCount * GetBlockWordCount());
+	}
+	else
+	{
+		brick.BlockId = m_FreeBlocks.back();
+		m_FreeBlocks.pop_back();
+	}
+
+	//Repeat the index across a whole word and fill the block with it.
+	uint32_t word = 0;
+	for (int bit = 0; bit < 32; bit += m_IndexBits)
+	{
+		word |= paletteId << bit;
+	}
+	std::fill_n(&m_Indices[brick.BlockId * GetBlockWordCount()], GetBlockWordCount(), word);
+}
+
+void BrickMap::MakeRawBrick(Brick& brick)
+{
+	assert(!(brick.BlockId & RawBrick) && "Brick has no index block!");
+	const uint32_t blockId = brick.BlockId;
+	brick.BlockId = AllocateRawBlock() | RawBrick;
+	uint32_t* pValues = GetRawValues(brick);
+	for (int i = 0; i < BrickVoxelCount; i++)
+	{
+		pValues[i] = m_Palette[ReadIndex(blockId, i)];
+	}
+	m_FreeBlocks.push_back(blockId);
+}
+
+uint32_t BrickMap::AllocateRawBlock()
+{
+	if (m_FreeRawBlocks.empty())
+	{
+		m_RawValues.resize(m_RawValues.size() + BrickVoxelCount);
+		return uint32_t(m_RawValues.size() / BrickVoxelCount - 1);
+	}
+	const uint32_t blockId = m_FreeRawBlocks.back();
+	m_FreeRawBlocks.pop_back();
+	return blockId;
+}
+
+bool BrickMap::IsBrickFilled(const Brick& brick, const glm::ivec3& brickId, uint32_t value) const
+{
+	const glm::ivec3 min = brickId * BrickSize;
+	const glm::ivec3 max = glm::min(min + BrickSize, glm::ivec3{ m_Width, m_Height, m_Depth });
+	const bool isRaw = (brick.BlockId & RawBrick) != 0;
+	for (int x = min.x; x < max.x; x++)
+	{
+		for (int y = min.y; y < max.y; y++)
+		{
+			for (int z = min.z; z < max.z; z++)
+			{
+				const int voxelOffset = GetVoxelOffset(x, y, z);
+				if ((isRaw ? GetRawValues(brick)[voxelOffset] : m_Palette[ReadIndex(brick.BlockId, voxelOffset)]) != value)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+void BrickMap::CollapseBrick(Brick& brick)
+{
+	assert(brick.BlockId != UniformBrick && "Brick is already uniform!");
+	if (brick.BlockId & RawBrick)
+		m_FreeRawBlocks.push_back(brick.BlockId & ~RawBrick);
+	else
+		m_FreeBlocks.push_back(brick.BlockId);
+	brick.BlockId = UniformBrick;
+	m_DenseBrickCount--;
+}
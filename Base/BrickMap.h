@@ -0,0 +1,121 @@
+#pragma once
+#include "Array3D.h"
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+const int BrickShift = 3;
+//Edge length in voxels of the cubic bricks a BrickMap is split in.
+const int BrickSize = 1 << BrickShift;
+const int BrickVoxelCount = BrickSize * BrickSize * BrickSize;
+
+//Sparse voxel storage: a flat grid of 8^3 bricks where a brick filled with a single value is stored as just that value.
+//Bricks with mixed content own a block of bit packed indices into a palette shared by the whole map. The indices start at 1 bit
+//and widen to 2, 4, 8 and 16 bits as new values appear, so a map with few distinct values stays a fraction of a dense array.
+//Values no brick uses anymore are dropped from the palette before the indices widen. Should the live values still not fit into
+//16 bits, the brick that needs another value stores its voxels as plain values instead.
+class BrickMap
+{
+public:
+	BrickMap(size_t width, size_t height, size_t depth, uint32_t value = 0);
+	explicit BrickMap(const Array3D<uint32_t>& data);
+
+	uint32_t Get(int x, int y, int z) const
+	{
+		assert(x >= 0 && y >= 0 && z >= 0 && size_t(x) < m_Width && size_t(y) < m_Height && size_t(z) < m_Depth && "Requesting voxel out of brick map bounds!");
+		const Brick& brick = m_Bricks[GetBrickId(x >> BrickShift, y >> BrickShift, z >> BrickShift)];
+		if (brick.BlockId == UniformBrick)
+			return brick.Value;
+		if (brick.BlockId & RawBrick)
+			return GetRawValues(brick)[GetVoxelOffset(x, y, z)];
+		return m_Palette[ReadIndex(brick.BlockId, GetVoxelOffset(x, y, z))];
+	}
+	uint32_t Get(const glm::ivec3& voxelId) const { return Get(voxelId.x, voxelId.y, voxelId.z); }
+	//Splits a uniform brick when the value differs and collapses the brick again once all of its voxels match.
+	void Set(const glm::ivec3& voxelId, uint32_t value);
+	//Replaces every voxel and starts over with an empty palette.
+	void Fill(uint32_t value);
+	//Replaces every voxel, bricks with a single value are collapsed and the palette only holds values still in use.
+	void Build(const Array3D<uint32_t>& data);
+	//Decodes the voxels in [min, max) into pValues, laid out x major like Array3D with the size of the region.
+	void Read(const glm::ivec3& min, const glm::ivec3& max, uint32_t* pValues) const;
+	void CopyTo(Array3D<uint32_t>& data) const;
+
+	glm::ivec3 GetBrickCount() const { return m_BrickCount; }
+	bool IsBrickUniform(const glm::ivec3& brickId) const { return m_Bricks[GetBrickId(brickId.x, brickId.y, brickId.z)].BlockId == UniformBrick; }
+	//Value of every voxel in a uniform brick.
+	uint32_t GetBrickValue(const glm::ivec3& brickId) const { return m_Bricks[GetBrickId(brickId.x, brickId.y, brickId.z)].Value; }
+	size_t GetDenseBrickCount() const { return m_DenseBrickCount; }
+	//True when every voxel has the same value, which is written to value.
+	bool IsUniform(uint32_t& value) const;
+	//Hash of the voxel values only, maps with the same content hash equal however their bricks and palette are laid out.
+	uint64_t GetHash() const;
+	bool operator==(const BrickMap& other) const;
+	bool operator!=(const BrickMap& other) const { return !(*this == other); }
+	//Values the dense bricks index into. Values that are no longer used stay in the palette until it runs out of indices.
+	size_t GetPaletteSize() const { return m_Palette.size(); }
+	int GetIndexBits() const { return m_IndexBits; }
+	//Approximate bytes used by the bricks, index blocks, raw blocks and palette, including blocks kept for reuse.
+	size_t GetMemorySize() const;
+
+	size_t GetWidth() const { return m_Width; }
+	size_t GetHeight() const { return m_Height; }
+	size_t GetDepth() const { return m_Depth; }
+
+private:
+	static const uint32_t UniformBrick = ~uint32_t(0);
+	//Set in the block id of a brick whose voxels are stored as plain values in m_RawValues.
+	static const uint32_t RawBrick = uint32_t(1) << 31;
+	static const uint32_t NoPaletteId = ~uint32_t(0);
+	static const int MaxIndexBits = 16;
+
+	struct Brick
+	{
+		uint32_t Value{};					//Value of every voxel while the brick is uniform
+		uint32_t BlockId{ UniformBrick };	//Block of indices in m_Indices, or of values in m_RawValues with RawBrick set
+	};
+
+	size_t GetBrickId(int x, int y, int z) const { return (size_t(x) * m_BrickCount.y + y) * m_BrickCount.z + z; }
+	static int GetVoxelOffset(int x, int y, int z) { return (((x & (BrickSize - 1)) << BrickShift | (y & (BrickSize - 1))) << BrickShift) | (z & (BrickSize - 1)); }
+	//Index widths are powers of two so an index never straddles two words.
+	uint32_t ReadIndex(uint32_t blockId, int voxelOffset) const
+	{
+		const size_t bitOffset = size_t(blockId) * BrickVoxelCount * m_IndexBits + size_t(voxelOffset) * m_IndexBits;
+		return (m_Indices[bitOffset >> 5] >> (bitOffset & 31)) & m_IndexMask;
+	}
+	void WriteIndex(uint32_t blockId, int voxelOffset, uint32_t paletteId);
+	const uint32_t* GetRawValues(const Brick& brick) const { return &m_RawValues[size_t(brick.BlockId & ~RawBrick) * BrickVoxelCount]; }
+	uint32_t* GetRawValues(const Brick& brick) { return &m_RawValues[size_t(brick.BlockId & ~RawBrick) * BrickVoxelCount]; }
+	//Adds the value to the palette if needed, compacting the palette or widening every block when the indices run out of bits.
+	//Returns NoPaletteId when even 16 bit indices can not address another value, ids handed out earlier may change.
+	uint32_t GetPaletteId(uint32_t value);
+	//Drops the values no index block refers to and renumbers the rest, keeping the index width.
+	void CompactPalette();
+	void WidenIndices(int indexBits);
+	void SplitBrick(Brick& brick);
+	//Moves the voxels of a palette brick into a block of plain values.
+	void MakeRawBrick(Brick& brick);
+	uint32_t AllocateRawBlock();
+	//True when every voxel inside the map has the value, the padding of a border brick is ignored.
+	bool IsBrickFilled(const Brick& brick, const glm::ivec3& brickId, uint32_t value) const;
+	//Frees the block of a dense brick whose voxels all have the same value.
+	void CollapseBrick(Brick& brick);
+	size_t GetBlockWordCount() const { return size_t(BrickVoxelCount) * m_IndexBits / 32; }
+
+	std::vector<Brick>		m_Bricks{};
+	std::vector<uint32_t>	m_Indices{};
+	std::vector<uint32_t>	m_FreeBlocks{};
+	std::vector<uint32_t>	m_RawValues{};
+	std::vector<uint32_t>	m_FreeRawBlocks{};
+	std::vector<uint32_t>	m_Palette{};
+	std::unordered_map<uint32_t, uint32_t>	m_PaletteIds{};
+	glm::ivec3				m_BrickCount{};
+	int						m_IndexBits{ 1 };
+	uint32_t				m_IndexMask{ 1 };
+	size_t					m_BlockCount{};
+	size_t					m_DenseBrickCount{};
+	size_t					m_Width{};
+	size_t					m_Height{};
+	size_t					m_Depth{};
+};
@@ -0,0 +1,93 @@
+#include "CpuFeatures.h"
+#include <stdint.h>
+#if CPU_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if CPU_X86
+static void QueryCpuid(int leaf, int subLeaf, uint32_t registers[4])
+{
+#ifdef _MSC_VER
+	int values[4];
+	__cpuidex(values, leaf, subLeaf);
+	for (int i = 0; i < 4; i++)
+	{
+		registers[i] = uint32_t(values[i]);
+	}
+#else
+	__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static uint64_t QueryEnabledRegisterStates()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t low, high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return (uint64_t(high) << 32) | low;
+#endif
+}
+#endif
+
+static CpuFeatures QueryCpuFeatures()
+{
+	CpuFeatures features{};
+#if CPU_X86
+	uint32_t registers[4]{};
+	QueryCpuid(0, 0, registers);
+	const uint32_t maxLeaf = registers[0];
+	if (maxLeaf < 1)
+		return features;
+
+	QueryCpuid(1, 0, registers);
+	const uint32_t ecx = registers[2];
+	features.HasSSE41 = (ecx & (1u << 19)) != 0;
+	//AVX needs the OS to save the YMM registers on a context switch, which XGETBV reports once OSXSAVE is set.
+	const bool hasOsXSave = (ecx & (1u << 27)) != 0;
+	const bool hasAVXInstructions = (ecx & (1u << 28)) != 0;
+	const bool isYmmSaved = hasOsXSave && (QueryEnabledRegisterStates() & 0x6) == 0x6;
+	features.HasAVX = hasAVXInstructions && isYmmSaved;
+	features.HasFMA = features.HasAVX && (ecx & (1u << 12)) != 0;
+	if (maxLeaf >= 7)
+	{
+		QueryCpuid(7, 0, registers);
+		features.HasAVX2 = features.HasAVX && (registers[1] & (1u << 5)) != 0;
+	}
+#endif
+	return features;
+}
+
+const CpuFeatures& GetCpuFeatures()
+{
+	static const CpuFeatures features = QueryCpuFeatures();
+	return features;
+}
+
+SimdLevel GetSupportedSimdLevel()
+{
+	const CpuFeatures& features = GetCpuFeatures();
+	if (features.HasAVX)
+		return SimdLevel::AVX;
+	if (features.HasSSE41)
+		return SimdLevel::SSE;
+	return SimdLevel::Scalar;
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX:
+		return "AVX";
+	case SimdLevel::SSE:
+		return "SSE";
+	default:
+		return "Scalar";
+	}
+}
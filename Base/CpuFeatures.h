@@ -0,0 +1,28 @@
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+//Widest instruction set a kernel can use, ordered from narrow to wide.
+enum class SimdLevel
+{
+	Scalar,
+	SSE,	//SSE4.1, 4 floats
+	AVX		//AVX, 8 floats
+};
+
+struct CpuFeatures
+{
+	bool HasSSE41{ false };
+	bool HasAVX{ false };	//Only set when the OS also saves the AVX registers
+	bool HasAVX2{ false };
+	bool HasFMA{ false };
+};
+
+//Queried once on first use.
+const CpuFeatures& GetCpuFeatures();
+SimdLevel GetSupportedSimdLevel();
+const char* GetSimdLevelName(SimdLevel level);
@@ -0,0 +1,98 @@
+#pragma once
+#include "Ray.h"
+#include <glm/glm.hpp>
+#include <float.h>
+#include <algorithm>
+
+//Walks the cells of a regular grid in the order a ray passes through them (Amanatides and Woo).
+//Cell (0, 0, 0) starts at origin and the grid spans gridSize cells of cellSize along every axis.
+class GridTraversal
+{
+public:
+	//Clips the part of the ray between minDist and maxDist to the grid, returns false when it misses.
+	bool Init(const Ray& ray, const glm::vec3& origin, const glm::ivec3& gridSize, float cellSize, float minDist, float maxDist)
+	{
+		const glm::vec3 start = (ray.Pos - origin) / cellSize;
+		m_GridSize = gridSize;
+		m_Step = {};
+		m_Normal = {};
+		m_EnterDistance = minDist;
+		m_MaxDistance = maxDist;
+		int enterAxis = -1;
+		glm::vec3 invDir{};
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (ray.Dir[axis] == 0.f)
+			{
+				if (start[axis] < 0.f || start[axis] >= float(gridSize[axis]))
+					return false;
+				continue;
+			}
+			m_Step[axis] = ray.Dir[axis] > 0.f ? 1 : -1;
+			invDir[axis] = cellSize / ray.Dir[axis];
+			float t0 = -start[axis] * invDir[axis];
+			float t1 = (float(gridSize[axis]) - start[axis]) * invDir[axis];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > m_EnterDistance)
+			{
+				m_EnterDistance = t0;
+				enterAxis = axis;
+			}
+			m_MaxDistance = glm::min(m_MaxDistance, t1);
+		}
+		if (m_EnterDistance > m_MaxDistance)
+			return false;
+
+		const glm::vec3 entry = start + ray.Dir * (m_EnterDistance / cellSize);
+		m_Cell = glm::clamp(glm::ivec3(glm::floor(entry)), glm::ivec3(0), gridSize - 1);
+		m_NextBoundary = glm::vec3{ FLT_MAX };
+		m_BoundaryDelta = glm::vec3{ FLT_MAX };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (m_Step[axis] == 0)
+				continue;
+			const float boundary = float(m_Cell[axis] + (m_Step[axis] > 0 ? 1 : 0));
+			m_NextBoundary[axis] = (boundary - start[axis]) * invDir[axis];
+			m_BoundaryDelta[axis] = float(m_Step[axis]) * invDir[axis];
+		}
+		if (enterAxis >= 0)
+			m_Normal[enterAxis] = -m_Step[enterAxis];
+		return true;
+	}
+
+	//Moves to the next cell, returns false once the ray leaves the grid or passes maxDist.
+	bool Step()
+	{
+		const int axis = GetExitAxis();
+		m_EnterDistance = m_NextBoundary[axis];
+		m_Cell[axis] += m_Step[axis];
+		if (m_EnterDistance > m_MaxDistance || m_Cell[axis] < 0 || m_Cell[axis] >= m_GridSize[axis])
+			return false;
+		m_NextBoundary[axis] += m_BoundaryDelta[axis];
+		m_Normal = {};
+		m_Normal[axis] = -m_Step[axis];
+		return true;
+	}
+
+	const glm::ivec3& GetCell() const { return m_Cell; }
+	//Outward normal of the cell face the ray entered through, zero when the ray starts inside the cell.
+	const glm::ivec3& GetNormal() const { return m_Normal; }
+	float GetEnterDistance() const { return m_EnterDistance; }
+	float GetExitDistance() const { return glm::min(m_NextBoundary[GetExitAxis()], m_MaxDistance); }
+
+private:
+	int GetExitAxis() const
+	{
+		return m_NextBoundary.x < m_NextBoundary.y ? (m_NextBoundary.x < m_NextBoundary.z ? 0 : 2) : (m_NextBoundary.y < m_NextBoundary.z ? 1 : 2);
+	}
+
+	glm::ivec3	m_GridSize{};
+	glm::ivec3	m_Cell{};
+	glm::ivec3	m_Step{};
+	glm::ivec3	m_Normal{};
+	glm::vec3	m_NextBoundary{};
+	glm::vec3	m_BoundaryDelta{};
+	float		m_EnterDistance{};
+	float		m_MaxDistance{};
+};
@@ -1,10 +1,9 @@
 #include "MathExtension.h"
+#include "VertexTransform.h"
 void TransformVector(std::vector<glm::vec3>& vertices, const glm::mat4x4& transform)
 {
-	for (glm::vec3& vertex : vertices)
-	{
-		vertex = transform * glm::vec4(vertex, 1.f);
-	}
+	float* pVertices = reinterpret_cast<float*>(vertices.data());
+	TransformVectors(pVertices, 3, pVertices, 3, vertices.size(), transform, TransformType::Point);
 }
 
 void TransformVector(std::vector<glm::vec4>& vertices, const glm::mat4x4& transform)
@@ -0,0 +1,353 @@
+#include "Noise.h"
+#include <cassert>
+#include <cmath>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+//GCC and Clang only emit SSE4.1 and AVX2 inside functions that ask for it, MSVC allows the intrinsics anywhere.
+#if CPU_X86 && !defined(_MSC_VER)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+const int MaxOctaves = 16;
+//Multipliers that spread the lattice coordinates over the hash, the hashes of neighbouring lattice points differ by a constant.
+const uint32_t HashPrimeX = 0x8da6b343;
+const uint32_t HashPrimeY = 0xd8163841;
+const uint32_t HashPrimeZ = 0xcb1ab31f;
+const uint32_t OctaveSeedStep = 0x9e3779b9;
+//Each axis adds at most 0.5 to the weighted gradients, so this maps the noise to [-1, 1].
+const float NoiseScale = 2.f / 3.f;
+
+//Frequency, amplitude and seed of every octave, computed once so every kernel uses the exact same values.
+struct Octaves
+{
+	int			Count{};
+	float		Frequencies[MaxOctaves]{};
+	float		Amplitudes[MaxOctaves]{};
+	uint32_t	Seeds[MaxOctaves]{};
+};
+
+static Octaves GetOctaves(uint32_t seed, const NoiseSettings& settings)
+{
+	assert(settings.Octaves > 0 && settings.Octaves <= MaxOctaves && "Unsupported octave count!");
+	Octaves octaves{};
+	octaves.Count = settings.Octaves;
+	float frequency = settings.Frequency;
+	float amplitude = NoiseScale;
+	for (int i = 0; i < octaves.Count; i++)
+	{
+		octaves.Frequencies[i] = frequency;
+		octaves.Amplitudes[i] = amplitude;
+		octaves.Seeds[i] = seed + uint32_t(i) * OctaveSeedStep;
+		frequency *= settings.Lacunarity;
+		amplitude *= settings.Gain;
+	}
+	return octaves;
+}
+
+float NoiseSettings::GetMaxAmplitude() const
+{
+	float sum = 0.f;
+	float amplitude = 1.f;
+	for (int i = 0; i < Octaves; i++)
+	{
+		sum += amplitude;
+		amplitude *= fabsf(Gain);
+	}
+	return sum;
+}
+
+static inline uint32_t Hash(uint32_t hashX, uint32_t hashY, uint32_t hashZ, uint32_t seed)
+{
+	uint32_t hash = hashX ^ hashY ^ hashZ ^ seed;
+	hash ^= hash >> 15;
+	hash *= 0x2c1b3c6d;
+	hash ^= hash >> 12;
+	hash *= 0x297a2d39;
+	hash ^= hash >> 15;
+	return hash;
+}
+
+//Dot product with one of the 8 diagonal gradients, the low 3 bits of the hash pick the signs.
+static inline float Gradient(uint32_t hash, float x, float y, float z)
+{
+	return ((hash & 1) ? -x : x) + ((hash & 2) ? -y : y) + ((hash & 4) ? -z : z);
+}
+
+static inline float Fade(float t)
+{
+	return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+}
+
+static inline float Lerp(float a, float b, float t)
+{
+	return a + t * (b - a);
+}
+
+static float GradientNoise(float x, float y, float z, uint32_t seed)
+{
+	const float floorX = floorf(x);
+	const float floorY = floorf(y);
+	const float floorZ = floorf(z);
+	const uint32_t hashX0 = uint32_t(int32_t(floorX)) * HashPrimeX;
+	const uint32_t hashY0 = uint32_t(int32_t(floorY)) * HashPrimeY;
+	const uint32_t hashZ0 = uint32_t(int32_t(floorZ)) * HashPrimeZ;
+	const uint32_t hashX1 = hashX0 + HashPrimeX;
+	const uint32_t hashY1 = hashY0 + HashPrimeY;
+	const uint32_t hashZ1 = hashZ0 + HashPrimeZ;
+	const float x0 = x - floorX;
+	const float y0 = y - floorY;
+	const float z0 = z - floorZ;
+	const float x1 = x0 - 1.f;
+	const float y1 = y0 - 1.f;
+	const float z1 = z0 - 1.f;
+
+	const float g000 = Gradient(Hash(hashX0, hashY0, hashZ0, seed), x0, y0, z0);
+	const float g100 = Gradient(Hash(hashX1, hashY0, hashZ0, seed), x1, y0, z0);
+	const float g010 = Gradient(Hash(hashX0, hashY1, hashZ0, seed), x0, y1, z0);
+	const float g110 = Gradient(Hash(hashX1, hashY1, hashZ0, seed), x1, y1, z0);
+	const float g001 = Gradient(Hash(hashX0, hashY0, hashZ1, seed), x0, y0, z1);
+	const float g101 = Gradient(Hash(hashX1, hashY0, hashZ1, seed), x1, y0, z1);
+	const float g011 = Gradient(Hash(hashX0, hashY1, hashZ1, seed), x0, y1, z1);
+	const float g111 = Gradient(Hash(hashX1, hashY1, hashZ1, seed), x1, y1, z1);
+
+	const float u = Fade(x0);
+	const float v = Fade(y0);
+	const float w = Fade(z0);
+	const float gy0 = Lerp(Lerp(g000, g100, u), Lerp(g010, g110, u), v);
+	const float gy1 = Lerp(Lerp(g001, g101, u), Lerp(g011, g111, u), v);
+	return Lerp(gy0, gy1, w);
+}
+
+static void FractalNoiseScalar(const float* pX, const float* pY, const float* pZ, size_t begin, size_t end, const Octaves& octaves, float* pResult)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float sum = 0.f;
+		for (int octave = 0; octave < octaves.Count; octave++)
+		{
+			const float frequency = octaves.Frequencies[octave];
+			sum += octaves.Amplitudes[octave] * GradientNoise(pX[i] * frequency, pY[i] * frequency, pZ[i] * frequency, octaves.Seeds[octave]);
+		}
+		pResult[i] = sum;
+	}
+}
+
+#if CPU_X86
+TARGET_SSE41 static inline __m128i HashSSE(__m128i hashX, __m128i hashY, __m128i hashZ, __m128i seed)
+{
+	__m128i hash = _mm_xor_si128(_mm_xor_si128(hashX, hashY), _mm_xor_si128(hashZ, seed));
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+	hash = _mm_mullo_epi32(hash, _mm_set1_epi32(0x2c1b3c6d));
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 12));
+	hash = _mm_mullo_epi32(hash, _mm_set1_epi32(0x297a2d39));
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+	return hash;
+}
+
+//Negating is flipping the sign bit, so the hash bits are shifted onto it.
+TARGET_SSE41 static inline __m128 GradientSSE(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128 signX = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hash, one), 31));
+	const __m128 signY = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(hash, 1), one), 31));
+	const __m128 signZ = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(hash, 2), one), 31));
+	return _mm_add_ps(_mm_add_ps(_mm_xor_ps(x, signX), _mm_xor_ps(y, signY)), _mm_xor_ps(z, signZ));
+}
+
+TARGET_SSE41 static inline __m128 FadeSSE(__m128 t)
+{
+	const __m128 polynomial = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.f)), _mm_set1_ps(15.f))), _mm_set1_ps(10.f));
+	return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), polynomial);
+}
+
+TARGET_SSE41 static inline __m128 LerpSSE(__m128 a, __m128 b, __m128 t)
+{
+	return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+TARGET_SSE41 static inline __m128 GradientNoiseSSE(__m128 x, __m128 y, __m128 z, __m128i seed)
+{
+	const __m128 floorX = _mm_floor_ps(x);
+	const __m128 floorY = _mm_floor_ps(y);
+	const __m128 floorZ = _mm_floor_ps(z);
+	const __m128i primeX = _mm_set1_epi32(int32_t(HashPrimeX));
+	const __m128i primeY = _mm_set1_epi32(int32_t(HashPrimeY));
+	const __m128i primeZ = _mm_set1_epi32(int32_t(HashPrimeZ));
+	const __m128i hashX0 = _mm_mullo_epi32(_mm_cvttps_epi32(floorX), primeX);
+	const __m128i hashY0 = _mm_mullo_epi32(_mm_cvttps_epi32(floorY), primeY);
+	const __m128i hashZ0 = _mm_mullo_epi32(_mm_cvttps_epi32(floorZ), primeZ);
+	const __m128i hashX1 = _mm_add_epi32(hashX0, primeX);
+	const __m128i hashY1 = _mm_add_epi32(hashY0, primeY);
+	const __m128i hashZ1 = _mm_add_epi32(hashZ0, primeZ);
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 x0 = _mm_sub_ps(x, floorX);
+	const __m128 y0 = _mm_sub_ps(y, floorY);
+	const __m128 z0 = _mm_sub_ps(z, floorZ);
+	const __m128 x1 = _mm_sub_ps(x0, one);
+	const __m128 y1 = _mm_sub_ps(y0, one);
+	const __m128 z1 = _mm_sub_ps(z0, one);
+
+	const __m128 g000 = GradientSSE(HashSSE(hashX0, hashY0, hashZ0, seed), x0, y0, z0);
+	const __m128 g100 = GradientSSE(HashSSE(hashX1, hashY0, hashZ0, seed), x1, y0, z0);
+	const __m128 g010 = GradientSSE(HashSSE(hashX0, hashY1, hashZ0, seed), x0, y1, z0);
+	const __m128 g110 = GradientSSE(HashSSE(hashX1, hashY1, hashZ0, seed), x1, y1, z0);
+	const __m128 g001 = GradientSSE(HashSSE(hashX0, hashY0, hashZ1, seed), x0, y0, z1);
+	const __m128 g101 = GradientSSE(HashSSE(hashX1, hashY0, hashZ1, seed), x1, y0, z1);
+	const __m128 g011 = GradientSSE(HashSSE(hashX0, hashY1, hashZ1, seed), x0, y1, z1);
+	const __m128 g111 = GradientSSE(HashSSE(hashX1, hashY1, hashZ1, seed), x1, y1, z1);
+
+	const __m128 u = FadeSSE(x0);
+	const __m128 v = FadeSSE(y0);
+	const __m128 w = FadeSSE(z0);
+	const __m128 gy0 = LerpSSE(LerpSSE(g000, g100, u), LerpSSE(g010, g110, u), v);
+	const __m128 gy1 = LerpSSE(LerpSSE(g001, g101, u), LerpSSE(g011, g111, u), v);
+	return LerpSSE(gy0, gy1, w);
+}
+
+//Returns how many lanes were processed, the remainder is left to the scalar kernel.
+TARGET_SSE41 static size_t FractalNoiseSSE(const float* pX, const float* pY, const float* pZ, size_t count, const Octaves& octaves, float* pResult)
+{
+	const size_t packetEnd = count / 4 * 4;
+	for (size_t lane = 0; lane < packetEnd; lane += 4)
+	{
+		const __m128 x = _mm_loadu_ps(pX + lane);
+		const __m128 y = _mm_loadu_ps(pY + lane);
+		const __m128 z = _mm_loadu_ps(pZ + lane);
+		__m128 sum = _mm_setzero_ps();
+		for (int octave = 0; octave < octaves.Count; octave++)
+		{
+			const __m128 frequency = _mm_set1_ps(octaves.Frequencies[octave]);
+			const __m128 noise = GradientNoiseSSE(_mm_mul_ps(x, frequency), _mm_mul_ps(y, frequency), _mm_mul_ps(z, frequency), _mm_set1_epi32(int32_t(octaves.Seeds[octave])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(octaves.Amplitudes[octave]), noise));
+		}
+		_mm_storeu_ps(pResult + lane, sum);
+	}
+	return packetEnd;
+}
+
+TARGET_AVX2 static inline __m256i HashAVX2(__m256i hashX, __m256i hashY, __m256i hashZ, __m256i seed)
+{
+	__m256i hash = _mm256_xor_si256(_mm256_xor_si256(hashX, hashY), _mm256_xor_si256(hashZ, seed));
+	hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+	hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x2c1b3c6d));
+	hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 12));
+	hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x297a2d39));
+	hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+	return hash;
+}
+
+TARGET_AVX2 static inline __m256 GradientAVX2(__m256i hash, __m256 x, __m256 y, __m256 z)
+{
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256 signX = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(hash, one), 31));
+	const __m256 signY = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(hash, 1), one), 31));
+	const __m256 signZ = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(hash, 2), one), 31));
+	return _mm256_add_ps(_mm256_add_ps(_mm256_xor_ps(x, signX), _mm256_xor_ps(y, signY)), _mm256_xor_ps(z, signZ));
+}
+
+TARGET_AVX2 static inline __m256 FadeAVX2(__m256 t)
+{
+	const __m256 polynomial = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.f)), _mm256_set1_ps(15.f))), _mm256_set1_ps(10.f));
+	return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), polynomial);
+}
+
+TARGET_AVX2 static inline __m256 LerpAVX2(__m256 a, __m256 b, __m256 t)
+{
+	return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+TARGET_AVX2 static inline __m256 GradientNoiseAVX2(__m256 x, __m256 y, __m256 z, __m256i seed)
+{
+	const __m256 floorX = _mm256_floor_ps(x);
+	const __m256 floorY = _mm256_floor_ps(y);
+	const __m256 floorZ = _mm256_floor_ps(z);
+	const __m256i primeX = _mm256_set1_epi32(int32_t(HashPrimeX));
+	const __m256i primeY = _mm256_set1_epi32(int32_t(HashPrimeY));
+	const __m256i primeZ = _mm256_set1_epi32(int32_t(HashPrimeZ));
+	const __m256i hashX0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floorX), primeX);
+	const __m256i hashY0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floorY), primeY);
+	const __m256i hashZ0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floorZ), primeZ);
+	const __m256i hashX1 = _mm256_add_epi32(hashX0, primeX);
+	const __m256i hashY1 = _mm256_add_epi32(hashY0, primeY);
+	const __m256i hashZ1 = _mm256_add_epi32(hashZ0, primeZ);
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 x0 = _mm256_sub_ps(x, floorX);
+	const __m256 y0 = _mm256_sub_ps(y, floorY);
+	const __m256 z0 = _mm256_sub_ps(z, floorZ);
+	const __m256 x1 = _mm256_sub_ps(x0, one);
+	const __m256 y1 = _mm256_sub_ps(y0, one);
+	const __m256 z1 = _mm256_sub_ps(z0, one);
+
+	const __m256 g000 = GradientAVX2(HashAVX2(hashX0, hashY0, hashZ0, seed), x0, y0, z0);
+	const __m256 g100 = GradientAVX2(HashAVX2(hashX1, hashY0, hashZ0, seed), x1, y0, z0);
+	const __m256 g010 = GradientAVX2(HashAVX2(hashX0, hashY1, hashZ0, seed), x0, y1, z0);
+	const __m256 g110 = GradientAVX2(HashAVX2(hashX1, hashY1, hashZ0, seed), x1, y1, z0);
+	const __m256 g001 = GradientAVX2(HashAVX2(hashX0, hashY0, hashZ1, seed), x0, y0, z1);
+	const __m256 g101 = GradientAVX2(HashAVX2(hashX1, hashY0, hashZ1, seed), x1, y0, z1);
+	const __m256 g011 = GradientAVX2(HashAVX2(hashX0, hashY1, hashZ1, seed), x0, y1, z1);
+	const __m256 g111 = GradientAVX2(HashAVX2(hashX1, hashY1, hashZ1, seed), x1, y1, z1);
+
+	const __m256 u = FadeAVX2(x0);
+	const __m256 v = FadeAVX2(y0);
+	const __m256 w = FadeAVX2(z0);
+	const __m256 gy0 = LerpAVX2(LerpAVX2(g000, g100, u), LerpAVX2(g010, g110, u), v);
+	const __m256 gy1 = LerpAVX2(LerpAVX2(g001, g101, u), LerpAVX2(g011, g111, u), v);
+	return LerpAVX2(gy0, gy1, w);
+}
+
+TARGET_AVX2 static size_t FractalNoiseAVX2(const float* pX, const float* pY, const float* pZ, size_t count, const Octaves& octaves, float* pResult)
+{
+	const size_t packetEnd = count / 8 * 8;
+	for (size_t lane = 0; lane < packetEnd; lane += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(pX + lane);
+		const __m256 y = _mm256_loadu_ps(pY + lane);
+		const __m256 z = _mm256_loadu_ps(pZ + lane);
+		__m256 sum = _mm256_setzero_ps();
+		for (int octave = 0; octave < octaves.Count; octave++)
+		{
+			const __m256 frequency = _mm256_set1_ps(octaves.Frequencies[octave]);
+			const __m256 noise = GradientNoiseAVX2(_mm256_mul_ps(x, frequency), _mm256_mul_ps(y, frequency), _mm256_mul_ps(z, frequency), _mm256_set1_epi32(int32_t(octaves.Seeds[octave])));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(octaves.Amplitudes[octave]), noise));
+		}
+		_mm256_storeu_ps(pResult + lane, sum);
+	}
+	return packetEnd;
+}
+#endif
+
+void FractalNoise(const float* pX, const float* pY, const float* pZ, size_t count, uint32_t seed, const NoiseSettings& settings, float* pResult)
+{
+	FractalNoise(pX, pY, pZ, count, seed, settings, pResult, GetSupportedSimdLevel());
+}
+
+void FractalNoise(const float* pX, const float* pY, const float* pZ, size_t count, uint32_t seed, const NoiseSettings& settings, float* pResult, SimdLevel level)
+{
+	//Never run a kernel the CPU can not execute, whatever the caller asked for.
+	if (int(level) > int(GetSupportedSimdLevel()))
+		level = GetSupportedSimdLevel();
+
+	const Octaves octaves = GetOctaves(seed, settings);
+	size_t processedCount = 0;
+#if CPU_X86
+	//The hash needs 256 bit integer math, CPUs with AVX but without AVX2 use the SSE kernel.
+	if (level == SimdLevel::AVX && GetCpuFeatures().HasAVX2)
+		processedCount = FractalNoiseAVX2(pX, pY, pZ, count, octaves, pResult);
+	else if (level != SimdLevel::Scalar)
+		processedCount = FractalNoiseSSE(pX, pY, pZ, count, octaves, pResult);
+#endif
+	FractalNoiseScalar(pX, pY, pZ, processedCount, count, octaves, pResult);
+}
+
+float FractalNoise(const glm::vec3& position, uint32_t seed, const NoiseSettings& settings)
+{
+	float result = 0.f;
+	FractalNoiseScalar(&position.x, &position.y, &position.z, 0, 1, GetOctaves(seed, settings), &result);
+	return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "CpuFeatures.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+
+//Fractal Brownian motion: octaves of gradient noise, each one at a higher frequency and a lower amplitude than the one before.
+struct NoiseSettings
+{
+	float	Frequency{ 1.f };	//Lattice cells per unit of the first octave
+	int		Octaves{ 1 };
+	float	Lacunarity{ 2.f };	//Frequency factor between octaves
+	float	Gain{ 0.5f };		//Amplitude factor between octaves
+
+	//Largest absolute value FractalNoise can return.
+	float GetMaxAmplitude() const;
+};
+
+//Gradient noise at (pX[i], pY[i], pZ[i]) summed over the octaves of settings, written to pResult[i]. Every octave is within [-1, 1].
+//The same seed and points give the same values on every thread, the kernels of every level run the same operations in the same order.
+//Uses the widest kernel the CPU supports, the overload with a level forces a narrower one.
+void FractalNoise(const float* pX, const float* pY, const float* pZ, size_t count, uint32_t seed, const NoiseSettings& settings, float* pResult);
+void FractalNoise(const float* pX, const float* pY, const float* pZ, size_t count, uint32_t seed, const NoiseSettings& settings, float* pResult, SimdLevel level);
+float FractalNoise(const glm::vec3& position, uint32_t seed, const NoiseSettings& settings);
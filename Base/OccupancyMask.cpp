@@ -0,0 +1,109 @@
+#include "OccupancyMask.h"
+#include <algorithm>
+
+OccupancyMask::OccupancyMask(size_t width, size_t height, size_t depth)
+	:m_Columns(width * height)
+	,m_Width{width}
+	,m_Height{height}
+	,m_Depth{depth}
+{
+	assert(depth <= 64 && "OccupancyMask columns are 64 bit, depth can not exceed 64 voxels!");
+}
+
+void OccupancyMask::Build(const Array3D<uint32_t>& data)
+{
+	assert(data.GetWidth() == m_Width && data.GetHeight() == m_Height && data.GetDepth() == m_Depth && "Data does not match the mask dimensions!");
+	const uint32_t* pValues = data.Data();
+	m_OccupiedCount = 0;
+	for (size_t column = 0; column < m_Columns.size(); column++)
+	{
+		uint64_t bits = 0;
+		for (size_t z = 0; z < m_Depth; z++)
+		{
+			bits |= uint64_t(pValues[z] != 0) << z;
+		}
+		m_Columns[column] = bits;
+		m_OccupiedCount += CountSetBits(bits);
+		pValues += m_Depth;
+	}
+}
+
+void OccupancyMask::Build(const BrickMap& data)
+{
+	assert(data.GetWidth() == m_Width && data.GetHeight() == m_Height && data.GetDepth() == m_Depth && "Data does not match the mask dimensions!");
+	std::fill(m_Columns.begin(), m_Columns.end(), 0);
+	const glm::ivec3 size{ m_Width, m_Height, m_Depth };
+	const glm::ivec3 brickCount = data.GetBrickCount();
+	for (int bx = 0; bx < brickCount.x; bx++)
+	{
+		for (int by = 0; by < brickCount.y; by++)
+		{
+			for (int bz = 0; bz < brickCount.z; bz++)
+			{
+				const glm::ivec3 brickId{ bx, by, bz };
+				const glm::ivec3 min = brickId * BrickSize;
+				const glm::ivec3 max = glm::min(min + BrickSize, size);
+				const bool isUniform = data.IsBrickUniform(brickId);
+				//A uniform brick sets or skips its whole z range at once.
+				if (isUniform && data.GetBrickValue(brickId) == 0)
+					continue;
+				const uint64_t rangeBits = ((max.z - min.z >= 64) ? ~uint64_t(0) : ((uint64_t(1) << (max.z - min.z)) - 1)) << min.z;
+				for (int x = min.x; x < max.x; x++)
+				{
+					for (int y = min.y; y < max.y; y++)
+					{
+						uint64_t& column = m_Columns[x * m_Height + y];
+						if (isUniform)
+						{
+							column |= rangeBits;
+							continue;
+						}
+						for (int z = min.z; z < max.z; z++)
+						{
+							column |= uint64_t(data.Get(x, y, z) != 0) << z;
+						}
+					}
+				}
+			}
+		}
+	}
+	m_OccupiedCount = 0;
+	for (uint64_t column : m_Columns)
+	{
+		m_OccupiedCount += CountSetBits(column);
+	}
+}
+
+void OccupancyMask::Set(const glm::ivec3& voxelId, bool isOccupied)
+{
+	assert(voxelId.x >= 0 && voxelId.y >= 0 && voxelId.z >= 0 && size_t(voxelId.x) < m_Width && size_t(voxelId.y) < m_Height && size_t(voxelId.z) < m_Depth && "Voxel out of mask bounds!");
+	uint64_t& column = m_Columns[voxelId.x * m_Height + voxelId.y];
+	const uint64_t bit = uint64_t(1) << voxelId.z;
+	if (((column & bit) != 0) != isOccupied)
+		m_OccupiedCount += isOccupied ? 1 : -1;
+	column = isOccupied ? (column | bit) : (column & ~bit);
+}
+
+bool OccupancyMask::IsSet(const glm::ivec3& voxelId) const
+{
+	if (voxelId.z < 0 || size_t(voxelId.z) >= m_Depth)
+		return false;
+	return (GetColumn(voxelId.x, voxelId.y) >> voxelId.z) & 1;
+}
+
+uint64_t OccupancyMask::GetColumn(int x, int y) const
+{
+	if (x < 0 || y < 0 || size_t(x) >= m_Width || size_t(y) >= m_Height)
+		return 0;
+	return m_Columns[x * m_Height + y];
+}
+
+uint64_t OccupancyMask::GetExposedFaces(int x, int y, const glm::ivec3& direction) const
+{
+	const uint64_t column = GetColumn(x, y);
+	if (direction.z > 0)
+		return column & ~(column >> 1);
+	if (direction.z < 0)
+		return column & ~(column << 1);
+	return column & ~GetColumn(x + direction.x, y + direction.y);
+}
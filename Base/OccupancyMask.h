@@ -0,0 +1,64 @@
+#pragma once
+#include "Array3D.h"
+#include "BrickMap.h"
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//Counts the zero bits below the lowest set bit, value must not be 0.
+inline int CountTrailingZeros(uint64_t value)
+{
+	assert(value != 0 && "CountTrailingZeros is undefined for 0!");
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return int(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+//Counts the set bits.
+inline int CountSetBits(uint64_t value)
+{
+#ifdef _MSC_VER
+	return int(__popcnt64(value));
+#else
+	return __builtin_popcountll(value);
+#endif
+}
+
+//One bit per voxel, stored as one 64 bit word per (x, y) column so a whole z row can be tested with a few shifts and ANDs.
+//Voxels outside of the mask are treated as empty.
+class OccupancyMask
+{
+public:
+	OccupancyMask(size_t width, size_t height, size_t depth);
+
+	//Rebuilds the mask from scratch, every non zero value is occupied.
+	void Build(const Array3D<uint32_t>& data);
+	void Build(const BrickMap& data);
+	void Set(const glm::ivec3& voxelId, bool isOccupied);
+	bool IsSet(const glm::ivec3& voxelId) const;
+
+	//Bit z of the column is set when voxel (x, y, z) is occupied, columns outside the mask are empty.
+	uint64_t GetColumn(int x, int y) const;
+	//Bits of the occupied voxels in column (x, y) whose neighbour in the given direction is empty.
+	uint64_t GetExposedFaces(int x, int y, const glm::ivec3& direction) const;
+
+	size_t GetWidth() const { return m_Width; }
+	size_t GetHeight() const { return m_Height; }
+	size_t GetDepth() const { return m_Depth; }
+	size_t GetOccupiedCount() const { return m_OccupiedCount; }
+	size_t GetMemorySize() const { return m_Columns.capacity() * sizeof(uint64_t); }
+
+private:
+	std::vector<uint64_t>	m_Columns{};
+	size_t					m_Width{};
+	size_t					m_Height{};
+	size_t					m_Depth{};
+	size_t					m_OccupiedCount{};
+};
@@ -1,4 +1,5 @@
 #include "Ray.h"
+#include <cmath>
 
 bool Ray::Intersect(const AABox& box, float& tenter, float& texit) const
 {
@@ -8,17 +9,17 @@ bool Ray::Intersect(const AABox& box, float& tenter, float& texit) const
 	float txmax = 0;
 	float tymax = 0;
 	float tzmax = 0;
-	if(abs(Dir.x) > FLT_EPSILON)
+	if(std::abs(Dir.x) > FLT_EPSILON)
 	{
 		txmin = (box.Position.x - Pos.x) / Dir.x;
 		txmax = (box.Position.x + box.Extent.x - Pos.x) / Dir.x;
 	}
-	if (abs(Dir.y) > FLT_EPSILON)
+	if (std::abs(Dir.y) > FLT_EPSILON)
 	{
 		tymin = (box.Position.y - Pos.y) / Dir.y;
 		tymax = (box.Position.y + box.Extent.y - Pos.y) / Dir.y;
 	}
-	if (abs(Dir.z) > FLT_EPSILON)
+	if (std::abs(Dir.z) > FLT_EPSILON)
 	{
 		tzmin = (box.Position.z - Pos.z) / Dir.z;
 		tzmax = (box.Position.z + box.Extent.z - Pos.z) / Dir.z;
@@ -39,3 +40,26 @@ glm::vec3 Ray::Traverse(float t) const
 {
 	return Pos+(t*Dir);
 }
+
+InvRay::InvRay(const Ray& ray)
+	:Pos{ray.Pos}
+	,InvDir{1.f / ray.Dir.x, 1.f / ray.Dir.y, 1.f / ray.Dir.z}
+{
+}
+
+bool InvRay::Intersect(const AABox& box, float& tenter, float& texit, float minDist, float maxDist) const
+{
+	tenter = minDist;
+	texit = maxDist;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float t0 = (box.Position[axis] - Pos[axis]) * InvDir[axis];
+		const float t1 = (box.Position[axis] + box.Extent[axis] - Pos[axis]) * InvDir[axis];
+		//Ordered so a NaN from 0 * infinity leaves tenter and texit untouched, the same way SSE min and max treat it.
+		const float tnear = t0 < t1 ? t0 : t1;
+		const float tfar = t0 > t1 ? t0 : t1;
+		tenter = tnear > tenter ? tnear : tenter;
+		texit = tfar < texit ? tfar : texit;
+	}
+	return tenter <= texit;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <glm/glm.hpp>
 #include "AABox.h"
+#include <float.h>
 struct Ray
 {
 	glm::vec3 Pos;
@@ -9,3 +10,14 @@ struct Ray
 	glm::vec3 Traverse(float t) const;
 };
 
+//Ray with the reciprocal direction precomputed, for testing one ray against many boxes.
+struct InvRay
+{
+	glm::vec3 Pos{};
+	glm::vec3 InvDir{};	//1 / Dir, infinite along the axes the ray does not move on
+
+	InvRay() = default;
+	explicit InvRay(const Ray& ray);
+	//Branchless slab test, only reports hits where the ray is inside the box somewhere between minDist and maxDist.
+	bool Intersect(const AABox& box, float& tenter, float& texit, float minDist = 0, float maxDist = FLT_MAX) const;
+};
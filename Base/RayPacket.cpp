@@ -0,0 +1,208 @@
+#include "RayPacket.h"
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+//GCC and Clang only emit AVX inside functions that ask for it, MSVC allows the intrinsics anywhere.
+#if CPU_X86 && !defined(_MSC_VER)
+#define TARGET_AVX __attribute__((target("avx")))
+#else
+#define TARGET_AVX
+#endif
+
+void AABoxSoA::Add(const AABox& box)
+{
+	MinX.push_back(box.Position.x);
+	MinY.push_back(box.Position.y);
+	MinZ.push_back(box.Position.z);
+	MaxX.push_back(box.Position.x + box.Extent.x);
+	MaxY.push_back(box.Position.y + box.Extent.y);
+	MaxZ.push_back(box.Position.z + box.Extent.z);
+}
+
+void AABoxSoA::Clear()
+{
+	MinX.clear();
+	MinY.clear();
+	MinZ.clear();
+	MaxX.clear();
+	MaxY.clear();
+	MaxZ.clear();
+}
+
+void InvRaySoA::Add(const InvRay& ray)
+{
+	PosX.push_back(ray.Pos.x);
+	PosY.push_back(ray.Pos.y);
+	PosZ.push_back(ray.Pos.z);
+	InvDirX.push_back(ray.InvDir.x);
+	InvDirY.push_back(ray.InvDir.y);
+	InvDirZ.push_back(ray.InvDir.z);
+}
+
+void InvRaySoA::Clear()
+{
+	PosX.clear();
+	PosY.clear();
+	PosZ.clear();
+	InvDirX.clear();
+	InvDirY.clear();
+	InvDirZ.clear();
+}
+
+//The kernels below take the ray as Pos xyz, InvDir xyz and the box as Min xyz, Max xyz. With IsRayPacket the ray arrays hold one
+//value per lane and the box arrays a single value shared by every lane, otherwise it is the other way around.
+
+template<bool IsRayPacket>
+static void IntersectScalar(const float* const pRay[6], const float* const pBox[6], size_t begin, size_t end, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		const size_t rayId = IsRayPacket ? i : 0;
+		const size_t boxId = IsRayPacket ? 0 : i;
+		float tenter = minDist;
+		float texit = maxDist;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float pos = pRay[axis][rayId];
+			const float invDir = pRay[3 + axis][rayId];
+			const float t0 = (pBox[axis][boxId] - pos) * invDir;
+			const float t1 = (pBox[3 + axis][boxId] - pos) * invDir;
+			const float tnear = t0 < t1 ? t0 : t1;
+			const float tfar = t0 > t1 ? t0 : t1;
+			tenter = tnear > tenter ? tnear : tenter;
+			texit = tfar < texit ? tfar : texit;
+		}
+		pHits[i] = tenter <= texit ? 1 : 0;
+		pEnterDistances[i] = tenter;
+	}
+}
+
+#if CPU_X86
+//Returns how many lanes were processed, the remainder is left to the scalar kernel.
+template<bool IsRayPacket>
+static size_t IntersectSSE(const float* const pRay[6], const float* const pBox[6], size_t count, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances)
+{
+	__m128 ray[6];
+	__m128 box[6];
+	for (int i = 0; i < 6; i++)
+	{
+		if (IsRayPacket)
+			box[i] = _mm_set1_ps(*pBox[i]);
+		else
+			ray[i] = _mm_set1_ps(*pRay[i]);
+	}
+
+	const size_t packetEnd = count / 4 * 4;
+	for (size_t lane = 0; lane < packetEnd; lane += 4)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (IsRayPacket)
+				ray[i] = _mm_loadu_ps(pRay[i] + lane);
+			else
+				box[i] = _mm_loadu_ps(pBox[i] + lane);
+		}
+		__m128 tenter = _mm_set1_ps(minDist);
+		__m128 texit = _mm_set1_ps(maxDist);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const __m128 t0 = _mm_mul_ps(_mm_sub_ps(box[axis], ray[axis]), ray[3 + axis]);
+			const __m128 t1 = _mm_mul_ps(_mm_sub_ps(box[3 + axis], ray[axis]), ray[3 + axis]);
+			tenter = _mm_max_ps(_mm_min_ps(t0, t1), tenter);
+			texit = _mm_min_ps(_mm_max_ps(t0, t1), texit);
+		}
+		_mm_storeu_ps(pEnterDistances + lane, tenter);
+		const int hitMask = _mm_movemask_ps(_mm_cmple_ps(tenter, texit));
+		for (int i = 0; i < 4; i++)
+		{
+			pHits[lane + i] = uint8_t((hitMask >> i) & 1);
+		}
+	}
+	return packetEnd;
+}
+
+template<bool IsRayPacket>
+TARGET_AVX static size_t IntersectAVX(const float* const pRay[6], const float* const pBox[6], size_t count, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances)
+{
+	__m256 ray[6];
+	__m256 box[6];
+	for (int i = 0; i < 6; i++)
+	{
+		if (IsRayPacket)
+			box[i] = _mm256_set1_ps(*pBox[i]);
+		else
+			ray[i] = _mm256_set1_ps(*pRay[i]);
+	}
+
+	const size_t packetEnd = count / 8 * 8;
+	for (size_t lane = 0; lane < packetEnd; lane += 8)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (IsRayPacket)
+				ray[i] = _mm256_loadu_ps(pRay[i] + lane);
+			else
+				box[i] = _mm256_loadu_ps(pBox[i] + lane);
+		}
+		__m256 tenter = _mm256_set1_ps(minDist);
+		__m256 texit = _mm256_set1_ps(maxDist);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(box[axis], ray[axis]), ray[3 + axis]);
+			const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(box[3 + axis], ray[axis]), ray[3 + axis]);
+			tenter = _mm256_max_ps(_mm256_min_ps(t0, t1), tenter);
+			texit = _mm256_min_ps(_mm256_max_ps(t0, t1), texit);
+		}
+		_mm256_storeu_ps(pEnterDistances + lane, tenter);
+		const int hitMask = _mm256_movemask_ps(_mm256_cmp_ps(tenter, texit, _CMP_LE_OQ));
+		for (int i = 0; i < 8; i++)
+		{
+			pHits[lane + i] = uint8_t((hitMask >> i) & 1);
+		}
+	}
+	return packetEnd;
+}
+#endif
+
+template<bool IsRayPacket>
+static void Intersect(const float* const pRay[6], const float* const pBox[6], size_t count, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances, SimdLevel level)
+{
+	//Never run a kernel the CPU can not execute, whatever the caller asked for.
+	if (int(level) > int(GetSupportedSimdLevel()))
+		level = GetSupportedSimdLevel();
+
+	size_t processedCount = 0;
+#if CPU_X86
+	if (level == SimdLevel::AVX)
+		processedCount = IntersectAVX<IsRayPacket>(pRay, pBox, count, minDist, maxDist, pHits, pEnterDistances);
+	else if (level == SimdLevel::SSE)
+		processedCount = IntersectSSE<IsRayPacket>(pRay, pBox, count, minDist, maxDist, pHits, pEnterDistances);
+#endif
+	IntersectScalar<IsRayPacket>(pRay, pBox, processedCount, count, minDist, maxDist, pHits, pEnterDistances);
+}
+
+void IntersectBoxes(const InvRay& ray, const AABoxSoA& boxes, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances)
+{
+	IntersectBoxes(ray, boxes, minDist, maxDist, pHits, pEnterDistances, GetSupportedSimdLevel());
+}
+
+void IntersectBoxes(const InvRay& ray, const AABoxSoA& boxes, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances, SimdLevel level)
+{
+	const float* const pRay[6] = { &ray.Pos.x, &ray.Pos.y, &ray.Pos.z, &ray.InvDir.x, &ray.InvDir.y, &ray.InvDir.z };
+	const float* const pBox[6] = { boxes.MinX.data(), boxes.MinY.data(), boxes.MinZ.data(), boxes.MaxX.data(), boxes.MaxY.data(), boxes.MaxZ.data() };
+	Intersect<false>(pRay, pBox, boxes.GetCount(), minDist, maxDist, pHits, pEnterDistances, level);
+}
+
+void IntersectRays(const InvRaySoA& rays, const AABox& box, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances)
+{
+	IntersectRays(rays, box, minDist, maxDist, pHits, pEnterDistances, GetSupportedSimdLevel());
+}
+
+void IntersectRays(const InvRaySoA& rays, const AABox& box, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances, SimdLevel level)
+{
+	const glm::vec3 boxMax = box.Position + box.Extent;
+	const float* const pRay[6] = { rays.PosX.data(), rays.PosY.data(), rays.PosZ.data(), rays.InvDirX.data(), rays.InvDirY.data(), rays.InvDirZ.data() };
+	const float* const pBox[6] = { &box.Position.x, &box.Position.y, &box.Position.z, &boxMax.x, &boxMax.y, &boxMax.z };
+	Intersect<true>(pRay, pBox, rays.GetCount(), minDist, maxDist, pHits, pEnterDistances, level);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Ray.h"
+#include "AABox.h"
+#include "CpuFeatures.h"
+#include <stdint.h>
+#include <vector>
+
+//Axis aligned boxes in structure of arrays form, so a SIMD kernel loads the same bound of several boxes at once.
+struct AABoxSoA
+{
+	std::vector<float> MinX{};
+	std::vector<float> MinY{};
+	std::vector<float> MinZ{};
+	std::vector<float> MaxX{};
+	std::vector<float> MaxY{};
+	std::vector<float> MaxZ{};
+
+	void Add(const AABox& box);
+	void Clear();
+	size_t GetCount() const { return MinX.size(); }
+};
+
+//Rays in structure of arrays form with the reciprocal direction precomputed.
+struct InvRaySoA
+{
+	std::vector<float> PosX{};
+	std::vector<float> PosY{};
+	std::vector<float> PosZ{};
+	std::vector<float> InvDirX{};
+	std::vector<float> InvDirY{};
+	std::vector<float> InvDirZ{};
+
+	void Add(const InvRay& ray);
+	void Clear();
+	size_t GetCount() const { return PosX.size(); }
+};
+
+//Tests one ray against every box with the same slab test as InvRay::Intersect. pHits[i] is set to 1 when box i is hit
+//between minDist and maxDist, otherwise 0, and pEnterDistances[i] receives the distance at which the ray enters it.
+//Uses the widest kernel the CPU supports, the overload with a level forces a narrower one.
+void IntersectBoxes(const InvRay& ray, const AABoxSoA& boxes, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances);
+void IntersectBoxes(const InvRay& ray, const AABoxSoA& boxes, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances, SimdLevel level);
+//Tests every ray against one box, the results are written per ray.
+void IntersectRays(const InvRaySoA& rays, const AABox& box, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances);
+void IntersectRays(const InvRaySoA& rays, const AABox& box, float minDist, float maxDist, uint8_t* pHits, float* pEnterDistances, SimdLevel level);
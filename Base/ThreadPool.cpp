@@ -0,0 +1,118 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+	m_Workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_JobAvailable.notify_all();
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Jobs.push_back(std::move(job));
+	}
+	m_JobAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_JobsDone.wait(lock, [this]() { return m_Jobs.empty() && m_ActiveJobCount == 0; });
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+{
+	if (count == 0)
+		return;
+	//Helpers can start after every range is taken and the call has returned, so they share the state instead of the stack.
+	struct RangeState
+	{
+		std::atomic<size_t>		NextRange{};
+		size_t					RangeCount{};
+		size_t					FinishedCount{};
+		std::mutex				Mutex{};
+		std::condition_variable	Done{};
+	};
+	grainSize = std::max(grainSize, size_t(1));
+	std::shared_ptr<RangeState> pState = std::make_shared<RangeState>();
+	pState->RangeCount = (count + grainSize - 1) / grainSize;
+	const std::function<void(size_t begin, size_t end)>* pFunction = &function;
+	//The function is only touched after claiming a range, which can not happen once the caller stopped waiting.
+	auto runRanges = [pState, pFunction, count, grainSize]()
+	{
+		for (size_t range = pState->NextRange++; range < pState->RangeCount; range = pState->NextRange++)
+		{
+			const size_t begin = range * grainSize;
+			(*pFunction)(begin, std::min(begin + grainSize, count));
+			std::lock_guard<std::mutex> lock(pState->Mutex);
+			if (++pState->FinishedCount == pState->RangeCount)
+				pState->Done.notify_one();
+		}
+	};
+
+	//Helpers go in front of the queued jobs, so a batch does not wait behind a backlog of long jobs.
+	const size_t helperCount = std::min(pState->RangeCount - 1, m_Workers.size());
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (size_t i = 0; i < helperCount; i++)
+		{
+			m_Jobs.push_front(runRanges);
+		}
+	}
+	for (size_t i = 0; i < helperCount; i++)
+	{
+		m_JobAvailable.notify_one();
+	}
+
+	runRanges();
+	std::unique_lock<std::mutex> lock(pState->Mutex);
+	pState->Done.wait(lock, [&pState]() { return pState->FinishedCount == pState->RangeCount; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobAvailable.wait(lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+			if (m_Jobs.empty())
+				return;
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+			m_ActiveJobCount++;
+		}
+		job();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_ActiveJobCount--;
+			if (m_Jobs.empty() && m_ActiveJobCount == 0)
+				m_JobsDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads that run submitted jobs in submission order.
+class ThreadPool
+{
+public:
+	//0 uses one thread per hardware core.
+	explicit ThreadPool(size_t threadCount = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(std::function<void()> job);
+	//Blocks until every submitted job has finished.
+	void Wait();
+	//Splits [0, count) in ranges of at most grainSize, runs function(begin, end) on every range and blocks until they are done.
+	//The calling thread runs ranges as well and helper jobs skip ahead of the queued jobs, so the call never waits for other
+	//work to drain. Only waits for its own ranges, so other jobs can keep running.
+	void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+	size_t GetThreadCount() const { return m_Workers.size(); }
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread>			m_Workers{};
+	std::deque<std::function<void()>>	m_Jobs{};
+	std::mutex							m_Mutex{};
+	std::condition_variable				m_JobAvailable{};
+	std::condition_variable				m_JobsDone{};
+	size_t								m_ActiveJobCount{};
+	bool								m_IsStopping{ false };
+};
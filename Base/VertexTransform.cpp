@@ -0,0 +1,254 @@
+#include "VertexTransform.h"
+#include <cmath>
+#include <cstring>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+//GCC and Clang only emit AVX inside functions that ask for it, MSVC allows the intrinsics anywhere.
+#if CPU_X86 && !defined(_MSC_VER)
+#define TARGET_AVX __attribute__((target("avx")))
+#else
+#define TARGET_AVX
+#endif
+
+//Rows of the 3x4 matrix every kernel applies to (x, y, z, 1), computed once per call so every kernel uses the exact same values.
+struct TransformRows
+{
+	float	Rows[3][4]{};
+	bool	IsNormalized{ false };
+};
+
+static TransformRows GetTransformRows(const glm::mat4x4& transform, TransformType type)
+{
+	glm::mat3x3 linear{ transform };
+	if (type == TransformType::Normal)
+		linear = glm::transpose(glm::inverse(linear));
+	TransformRows rows{};
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			rows.Rows[row][column] = linear[column][row];
+		}
+		rows.Rows[row][3] = type == TransformType::Point ? transform[3][row] : 0.f;
+	}
+	rows.IsNormalized = type == TransformType::Normal;
+	return rows;
+}
+
+//Component c of vector i is at pSource[c][i * stride], the kernels below do the same operations in the same order as this one.
+static void TransformScalar(const float* const pSource[3], size_t sourceStride, float* const pDestination[3], size_t destinationStride, size_t begin, size_t end, const TransformRows& rows)
+{
+	//A local copy, stores to the destination could alias the rows and force them to be reloaded for every vector.
+	float m[3][4];
+	memcpy(m, rows.Rows, sizeof(m));
+	const bool isNormalized = rows.IsNormalized;
+	for (size_t i = begin; i < end; i++)
+	{
+		const float x = pSource[0][i * sourceStride];
+		const float y = pSource[1][i * sourceStride];
+		const float z = pSource[2][i * sourceStride];
+		float result[3];
+		for (int row = 0; row < 3; row++)
+		{
+			result[row] = m[row][0] * x + m[row][1] * y + m[row][2] * z + m[row][3];
+		}
+		if (isNormalized)
+		{
+			const float lengthSquared = result[0] * result[0] + result[1] * result[1] + result[2] * result[2];
+			const float invLength = lengthSquared > 0.f ? 1.f / std::sqrt(lengthSquared) : 0.f;
+			for (float& component : result)
+			{
+				component *= invLength;
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			pDestination[c][i * destinationStride] = result[c];
+		}
+	}
+}
+
+#if CPU_X86
+//Separate x, y and z arrays, 4 vectors at once. Returns how many vectors were processed, the remainder is left to the scalar kernel.
+static size_t TransformSoASSE(const float* const pSource[3], float* const pDestination[3], size_t count, const TransformRows& rows)
+{
+	__m128 m[3][4];
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			m[row][column] = _mm_set1_ps(rows.Rows[row][column]);
+		}
+	}
+	const size_t packetEnd = count / 4 * 4;
+	for (size_t i = 0; i < packetEnd; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(pSource[0] + i);
+		const __m128 y = _mm_loadu_ps(pSource[1] + i);
+		const __m128 z = _mm_loadu_ps(pSource[2] + i);
+		__m128 result[3];
+		for (int row = 0; row < 3; row++)
+		{
+			result[row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row][0], x), _mm_mul_ps(m[row][1], y)), _mm_mul_ps(m[row][2], z)), m[row][3]);
+		}
+		if (rows.IsNormalized)
+		{
+			const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(result[0], result[0]), _mm_mul_ps(result[1], result[1])), _mm_mul_ps(result[2], result[2]));
+			const __m128 invLength = _mm_and_ps(_mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(lengthSquared)));
+			for (__m128& component : result)
+			{
+				component = _mm_mul_ps(component, invLength);
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			_mm_storeu_ps(pDestination[c] + i, result[c]);
+		}
+	}
+	return packetEnd;
+}
+
+TARGET_AVX static size_t TransformSoAAVX(const float* const pSource[3], float* const pDestination[3], size_t count, const TransformRows& rows)
+{
+	__m256 m[3][4];
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			m[row][column] = _mm256_set1_ps(rows.Rows[row][column]);
+		}
+	}
+	const size_t packetEnd = count / 8 * 8;
+	for (size_t i = 0; i < packetEnd; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(pSource[0] + i);
+		const __m256 y = _mm256_loadu_ps(pSource[1] + i);
+		const __m256 z = _mm256_loadu_ps(pSource[2] + i);
+		__m256 result[3];
+		for (int row = 0; row < 3; row++)
+		{
+			result[row] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row][0], x), _mm256_mul_ps(m[row][1], y)), _mm256_mul_ps(m[row][2], z)), m[row][3]);
+		}
+		if (rows.IsNormalized)
+		{
+			const __m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(result[0], result[0]), _mm256_mul_ps(result[1], result[1])), _mm256_mul_ps(result[2], result[2]));
+			const __m256 invLength = _mm256_and_ps(_mm256_cmp_ps(lengthSquared, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(lengthSquared)));
+			for (__m256& component : result)
+			{
+				component = _mm256_mul_ps(component, invLength);
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			_mm256_storeu_ps(pDestination[c] + i, result[c]);
+		}
+	}
+	return packetEnd;
+}
+
+//Strided vectors one at a time, the components of a vector are broadcast against the columns of the matrix so the rows are computed
+//in the lanes of one register. Gathering several strided vectors into separate x, y and z registers costs more than the math, so this
+//also serves the AVX level.
+static void TransformStridedSSE(const float* pSource, size_t sourceStride, float* pDestination, size_t destinationStride, size_t count, const TransformRows& rows)
+{
+	__m128 columns[4];
+	for (int column = 0; column < 4; column++)
+	{
+		columns[column] = _mm_setr_ps(rows.Rows[0][column], rows.Rows[1][column], rows.Rows[2][column], 0.f);
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* pVector = pSource + i * sourceStride;
+		const __m128 x = _mm_mul_ps(columns[0], _mm_set1_ps(pVector[0]));
+		const __m128 y = _mm_mul_ps(columns[1], _mm_set1_ps(pVector[1]));
+		const __m128 z = _mm_mul_ps(columns[2], _mm_set1_ps(pVector[2]));
+		__m128 result = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), columns[3]);
+		if (rows.IsNormalized)
+		{
+			const __m128 squared = _mm_mul_ps(result, result);
+			const __m128 lengthSquared = _mm_add_ss(_mm_add_ss(squared, _mm_shuffle_ps(squared, squared, 1)), _mm_movehl_ps(squared, squared));
+			const __m128 invLength = _mm_and_ps(_mm_cmpgt_ss(lengthSquared, _mm_setzero_ps()), _mm_div_ss(_mm_set_ss(1.f), _mm_sqrt_ss(lengthSquared)));
+			result = _mm_mul_ps(result, _mm_shuffle_ps(invLength, invLength, 0));
+		}
+		float* pResult = pDestination + i * destinationStride;
+		_mm_storel_pi(reinterpret_cast<__m64*>(pResult), result);
+		_mm_store_ss(pResult + 2, _mm_movehl_ps(result, result));
+	}
+}
+#endif
+
+//Without translation an identity upper 3x3 leaves vectors and normals as they are.
+static TransformType GetEffectiveType(const glm::mat4x4& transform, TransformType type)
+{
+	if (type != TransformType::Point && glm::mat3x3(transform) == glm::mat3x3(1.f))
+		return TransformType::None;
+	return type;
+}
+
+void TransformVectors(const float* const pSource[3], float* const pDestination[3], size_t count, const glm::mat4x4& transform, TransformType type)
+{
+	TransformVectors(pSource, pDestination, count, transform, type, GetSupportedSimdLevel());
+}
+
+void TransformVectors(const float* const pSource[3], float* const pDestination[3], size_t count, const glm::mat4x4& transform, TransformType type, SimdLevel level)
+{
+	//Never run a kernel the CPU can not execute, whatever the caller asked for.
+	if (int(level) > int(GetSupportedSimdLevel()))
+		level = GetSupportedSimdLevel();
+	type = GetEffectiveType(transform, type);
+	if (type == TransformType::None)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			if (pDestination[c] != pSource[c])
+				memmove(pDestination[c], pSource[c], count * sizeof(float));
+		}
+		return;
+	}
+
+	const TransformRows rows = GetTransformRows(transform, type);
+	size_t processedCount = 0;
+#if CPU_X86
+	if (level == SimdLevel::AVX)
+		processedCount = TransformSoAAVX(pSource, pDestination, count, rows);
+	else if (level == SimdLevel::SSE)
+		processedCount = TransformSoASSE(pSource, pDestination, count, rows);
+#endif
+	TransformScalar(pSource, 1, pDestination, 1, processedCount, count, rows);
+}
+
+void TransformVectors(const float* pSource, size_t sourceStride, float* pDestination, size_t destinationStride, size_t count, const glm::mat4x4& transform, TransformType type)
+{
+	TransformVectors(pSource, sourceStride, pDestination, destinationStride, count, transform, type, GetSupportedSimdLevel());
+}
+
+void TransformVectors(const float* pSource, size_t sourceStride, float* pDestination, size_t destinationStride, size_t count, const glm::mat4x4& transform, TransformType type, SimdLevel level)
+{
+	if (int(level) > int(GetSupportedSimdLevel()))
+		level = GetSupportedSimdLevel();
+	type = GetEffectiveType(transform, type);
+	if (type == TransformType::None)
+	{
+		if (pDestination == pSource && destinationStride == sourceStride)
+			return;
+		for (size_t i = 0; i < count; i++)
+		{
+			memmove(pDestination + i * destinationStride, pSource + i * sourceStride, 3 * sizeof(float));
+		}
+		return;
+	}
+
+	const TransformRows rows = GetTransformRows(transform, type);
+#if CPU_X86
+	if (level != SimdLevel::Scalar)
+	{
+		TransformStridedSSE(pSource, sourceStride, pDestination, destinationStride, count, rows);
+		return;
+	}
+#endif
+	const float* const pSourceComponents[3] = { pSource, pSource + 1, pSource + 2 };
+	float* const pDestinationComponents[3] = { pDestination, pDestination + 1, pDestination + 2 };
+	TransformScalar(pSourceComponents, sourceStride, pDestinationComponents, destinationStride, 0, count, rows);
+}
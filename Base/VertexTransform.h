@@ -0,0 +1,15 @@
+#pragma once
+#include "CpuFeatures.h"
+#include "VertexTypes.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+
+//Transforms count 3 component vectors stored as separate x, y and z arrays, pSource[0] holds the x components. The destination
+//may be the source. Points, vectors and normals are transformed as described by TransformType, TransformType::None copies.
+//Uses the widest kernel the CPU supports, the overload with a level forces a narrower one. Every level gives the same results.
+void TransformVectors(const float* const pSource[3], float* const pDestination[3], size_t count, const glm::mat4x4& transform, TransformType type);
+void TransformVectors(const float* const pSource[3], float* const pDestination[3], size_t count, const glm::mat4x4& transform, TransformType type, SimdLevel level);
+//Same for vectors whose components follow each other and whose starts are stride floats apart, such as an attribute of an
+//interleaved vertex buffer or a std::vector<glm::vec3> with stride 3. The destination may be the source if the strides match.
+void TransformVectors(const float* pSource, size_t sourceStride, float* pDestination, size_t destinationStride, size_t count, const glm::mat4x4& transform, TransformType type);
+void TransformVectors(const float* pSource, size_t sourceStride, float* pDestination, size_t destinationStride, size_t count, const glm::mat4x4& transform, TransformType type, SimdLevel level);
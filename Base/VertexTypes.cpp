@@ -1,24 +1,11 @@
 #include "VertexTypes.h"
-
-size_t GetVertexTypeSize(VertexAttribute type)
-{
-	switch (type)
-	{
-	case VertexAttribute::PADDINGFLOAT:
-	case VertexAttribute::FLOAT:
-		return sizeof(float);
-	case VertexAttribute::UV:
-	case VertexAttribute::PADDINGVEC2:
-	case VertexAttribute::VEC2:
-		return 2 * sizeof(float);
-	case VertexAttribute::COLOR:
-	case VertexAttribute::PADDINGVEC4:
-	case VertexAttribute::VEC4:
-		return 4 * sizeof(float);
-	default:
-		return 3 * sizeof(float);
-	}
-}
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
+#if CPU_X86
+#include <emmintrin.h>
+#endif
 
 size_t GetStride(const std::vector<VertexAttribute>& attributes)
 {
@@ -30,17 +17,44 @@ size_t GetStride(const std::vector<VertexAttribute>& attributes)
 	return stride;
 }
 
-bool IsAffectedByTransform(VertexAttribute type)
+//Both use SSE2, which every x64 CPU has.
+uint32_t* OffsetIndices(const uint32_t* pSource, size_t count, uint32_t offset, uint32_t* pDestination)
+{
+	size_t i = 0;
+#if CPU_X86
+	const __m128i offsets = _mm_set1_epi32(int(offset));
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + i), _mm_add_epi32(indices, offsets));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		pDestination[i] = pSource[i] + offset;
+	}
+	return pDestination + count;
+}
+
+uint16_t* OffsetIndices(const uint32_t* pSource, size_t count, uint32_t offset, uint16_t* pDestination)
 {
-	switch (type)
+	//Checked up front, the SIMD loop saturates instead of failing.
+	assert((count == 0 || uint64_t(*std::max_element(pSource, pSource + count)) + offset <= 0xFFFF) && "Indices do not fit into 16 bits!");
+	size_t i = 0;
+#if CPU_X86
+	//SSE2 only packs with signed saturation, so the indices are moved into the signed range and back.
+	const __m128i offsets = _mm_set1_epi32(int(offset) - 0x8000);
+	const __m128i bias = _mm_set1_epi16(-0x8000);
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i low = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i)), offsets);
+		const __m128i high = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i + 4)), offsets);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + i), _mm_add_epi16(_mm_packs_epi32(low, high), bias));
+	}
+#endif
+	for (; i < count; i++)
 	{
-	//case VertexAttribute::NORMAL:
-	case VertexAttribute::POSITION:
-	case VertexAttribute::TANGENT:
-	case VertexAttribute::BITANGENT:
-		return true;
-	default:
-		return false;
-		break;
+		pDestination[i] = uint16_t(pSource[i] + offset);
 	}
+	return pDestination + count;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include <vector>
 enum class VertexAttribute
 {
@@ -12,12 +13,115 @@ enum class VertexAttribute
 	VEC2,
 	VEC3,
 	VEC4,
+	UINT,	//Single 32 bit unsigned integer
+	UBYTE4,	//Four 8 bit unsigned integers packed in 32 bits
 	PADDINGFLOAT,
 	PADDINGVEC2,
 	PADDINGVEC3,
 	PADDINGVEC4
 };
+//Number of VertexAttribute values, for tables indexed by attribute.
+const size_t VertexAttributeCount = size_t(VertexAttribute::PADDINGVEC4) + 1;
+
+constexpr size_t GetVertexTypeSize(VertexAttribute type)
+{
+	switch (type)
+	{
+	case VertexAttribute::PADDINGFLOAT:
+	case VertexAttribute::FLOAT:
+		return sizeof(float);
+	case VertexAttribute::UINT:
+	case VertexAttribute::UBYTE4:
+		return sizeof(uint32_t);
+	case VertexAttribute::UV:
+	case VertexAttribute::PADDINGVEC2:
+	case VertexAttribute::VEC2:
+		return 2 * sizeof(float);
+	case VertexAttribute::COLOR:
+	case VertexAttribute::PADDINGVEC4:
+	case VertexAttribute::VEC4:
+		return 4 * sizeof(float);
+	default:
+		return 3 * sizeof(float);
+	}
+}
 
-size_t GetVertexTypeSize(VertexAttribute type);
 size_t GetStride(const std::vector<VertexAttribute>& attributes);
-bool IsAffectedByTransform(VertexAttribute type);
+
+//Width of the indices of a mesh.
+enum class IndexType
+{
+	UINT16,
+	UINT32
+};
+
+//The narrowest index type that can address vertexCount vertices.
+constexpr IndexType GetIndexType(size_t vertexCount)
+{
+	return vertexCount <= 65536 ? IndexType::UINT16 : IndexType::UINT32;
+}
+
+constexpr size_t GetIndexTypeSize(IndexType type)
+{
+	return type == IndexType::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+//Writes pSource[i] + offset to pDestination[i] and returns the next write position. Every result has to fit the destination type.
+uint32_t* OffsetIndices(const uint32_t* pSource, size_t count, uint32_t offset, uint32_t* pDestination);
+uint16_t* OffsetIndices(const uint32_t* pSource, size_t count, uint32_t offset, uint16_t* pDestination);
+
+//How a vertex attribute follows a transform of its mesh.
+enum class TransformType
+{
+	None,
+	Point,		//Multiplied by the matrix with w = 1
+	Vector,		//Multiplied by the upper 3x3 of the matrix, without translation
+	Normal		//Multiplied by the inverse transpose of the upper 3x3 and normalized, so it stays perpendicular to the surface
+};
+
+constexpr TransformType GetTransformType(VertexAttribute type)
+{
+	switch (type)
+	{
+	case VertexAttribute::POSITION:
+		return TransformType::Point;
+	case VertexAttribute::NORMAL:
+		return TransformType::Normal;
+	case VertexAttribute::TANGENT:
+	case VertexAttribute::BITANGENT:
+		return TransformType::Vector;
+	default:
+		return TransformType::None;
+	}
+}
+
+constexpr bool IsAffectedByTransform(VertexAttribute type)
+{
+	return GetTransformType(type) != TransformType::None;
+}
+
+//Byte offset of attribute index in a vertex of the given attributes, the stride for index == sizeof...(Attributes).
+template<VertexAttribute... Attributes>
+constexpr size_t GetLayoutOffset(size_t index)
+{
+	const size_t sizes[] = { GetVertexTypeSize(Attributes)... };
+	size_t offset = 0;
+	for (size_t i = 0; i < index; i++)
+	{
+		offset += sizes[i];
+	}
+	return offset;
+}
+
+//Vertex layout known at compile time, e.g. VertexLayoutT<VertexAttribute::POSITION, VertexAttribute::COLOR>. Mesh and vkw::VertexLayout
+//take it in place of a std::vector<VertexAttribute> and generate their writers and attribute descriptions for it at compile time.
+template<VertexAttribute... Attributes>
+struct VertexLayoutT
+{
+	static_assert(sizeof...(Attributes) > 0, "A vertex layout needs at least one attribute!");
+	static constexpr size_t AttributeCount = sizeof...(Attributes);
+	static constexpr size_t Stride = GetLayoutOffset<Attributes...>(sizeof...(Attributes));
+
+	static constexpr size_t GetOffset(size_t index) { return GetLayoutOffset<Attributes...>(index); }
+	static std::vector<VertexAttribute> GetAttributes() { return { Attributes... }; }
+};
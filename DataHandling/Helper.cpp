@@ -1,6 +1,13 @@
 #include "Helper.h"
 #include <fstream>
 #include <cassert>
+#include <cstdio>
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 std::vector<char> readFile(const std::string& filename)
 {
@@ -20,6 +27,59 @@ std::vector<char> readFile(const std::string& filename)
 	return buffer;
 }
 
+bool WriteFileAtomic(const std::string& filename, const void* pData, size_t size)
+{
+	const std::string tempFilename = filename + ".tmp";
+	FILE* pFile = fopen(tempFilename.c_str(), "wb");
+	if (!pFile)
+		return false;
+	bool isWritten = fwrite(pData, 1, size, pFile) == size && fflush(pFile) == 0;
+	//Flush to the disk before the rename, or a crash could leave the new name pointing at missing data.
+#ifdef _WIN32
+	isWritten = isWritten && _commit(_fileno(pFile)) == 0;
+#else
+	isWritten = isWritten && fsync(fileno(pFile)) == 0;
+#endif
+	isWritten = fclose(pFile) == 0 && isWritten;
+	if (isWritten)
+	{
+#ifdef _WIN32
+		isWritten = MoveFileExA(tempFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		isWritten = rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+	}
+	if (!isWritten)
+		remove(tempFilename.c_str());
+	return isWritten;
+}
+
+bool WriteFileRegions(const std::string& filename, const std::vector<FileWrite>& writes)
+{
+	FILE* pFile = fopen(filename.c_str(), "r+b");
+	if (!pFile)
+		return false;
+	bool isWritten = true;
+	for (const FileWrite& write : writes)
+	{
+		//The 64 bit seeks, fseek only takes a long which is 32 bits on Windows.
+#ifdef _WIN32
+		isWritten = isWritten && _fseeki64(pFile, int64_t(write.Offset), SEEK_SET) == 0;
+#else
+		isWritten = isWritten && fseeko(pFile, off_t(write.Offset), SEEK_SET) == 0;
+#endif
+		isWritten = isWritten && fwrite(write.pData, 1, write.Size, pFile) == write.Size;
+	}
+	isWritten = isWritten && fflush(pFile) == 0;
+#ifdef _WIN32
+	isWritten = isWritten && _commit(_fileno(pFile)) == 0;
+#else
+	isWritten = isWritten && fsync(fileno(pFile)) == 0;
+#endif
+	isWritten = fclose(pFile) == 0 && isWritten;
+	return isWritten;
+}
+
 std::string GetFilePath(const std::string& str)
 {
 	size_t found = str.find_last_of("/\\");
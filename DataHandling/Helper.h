@@ -1,7 +1,20 @@
 #pragma once
+#include <stdint.h>
 #include <vector>
 #include <string>
 std::vector<char> readFile(const std::string& filename);
+//Writes the data next to the file and moves it over the file once it is on disk, so the file is never seen half written.
+//Returns false when the data could not be written, the old file is left as it was.
+bool WriteFileAtomic(const std::string& filename, const void* pData, size_t size);
+struct FileWrite
+{
+	uint64_t	Offset{};
+	const void*	pData{};
+	size_t		Size{};
+};
+//Writes into an existing file in place, in the given order, and flushes the data to the disk before returning. An offset at the end
+//of the file appends. Returns false when the file could not be opened or a write failed, the writes before it might have happened.
+bool WriteFileRegions(const std::string& filename, const std::vector<FileWrite>& writes);
 std::string GetFilePath(const std::string& str);
 std::string GetSuffix(const std::string& filepath);
 std::string GetFileName(const std::string& filepath, bool removeExtension = false);
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_Size = size_t(size.QuadPart);
+	if (m_Size > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			m_pData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			//The view keeps the mapping alive.
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	const int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	struct stat status{};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		return false;
+	}
+	m_Size = size_t(status.st_size);
+	if (m_Size > 0)
+	{
+		void* pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (pData != MAP_FAILED)
+			m_pData = static_cast<const uint8_t*>(pData);
+	}
+	//The mapping keeps the file alive.
+	close(file);
+#endif
+	if (m_Size > 0 && !m_pData)
+	{
+		m_Size = 0;
+		return false;
+	}
+	m_IsOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<uint8_t*>(m_pData), m_Size);
+#endif
+	}
+	m_pData = nullptr;
+	m_Size = 0;
+	m_IsOpen = false;
+}
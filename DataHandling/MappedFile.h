@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+//Read only view of a whole file through the virtual memory system. Pages are only read from disk once they are touched,
+//so looking at a small part of a big file costs a page fault instead of a copy of the file.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Returns false when the file does not exist or can not be mapped. An empty file opens without data.
+	bool Open(const std::string& filename);
+	void Close();
+	bool IsOpen() const { return m_IsOpen; }
+	const uint8_t* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+private:
+	const uint8_t*	m_pData = nullptr;
+	size_t			m_Size{};
+	bool			m_IsOpen{ false };
+};
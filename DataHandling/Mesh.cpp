@@ -1,5 +1,6 @@
 #include "Mesh.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 
 std::vector<float> Mesh::CreateVertices(const std::vector<VertexAttribute>& vertexTypes, const glm::mat4x4& transform)
@@ -10,34 +11,83 @@ std::vector<float> Mesh::CreateVertices(const std::vector<VertexAttribute>& vert
 	return vertices;
 }
 
+//Everything a call of CreateVertices needs to write one attribute, looked up once before the vertex loop.
+struct AttributeWrite
+{
+	const float*	pSource{};
+	size_t			SourceCount{};	//Vertices in pSource, the remaining vertices repeat the last one or are 0 without any
+	size_t			FloatCount{};
+	TransformType	Transform{ TransformType::None };
+};
+
+template<size_t FloatCount>
+static void CopyStrided(const float* pSource, size_t count, float* pDestination, size_t stride)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(pDestination, pSource, FloatCount * sizeof(float));
+		pSource += FloatCount;
+		pDestination += stride;
+	}
+}
+
+static void WriteStridedAttribute(const AttributeWrite& write, size_t vertexCount, float* pDestination, size_t stride, const glm::mat4x4& transform)
+{
+	if (write.Transform != TransformType::None)
+	{
+		assert(write.FloatCount == 3 && "Attribute size is not supported for transform but has a TransformType");
+		TransformVectors(write.pSource, write.FloatCount, pDestination, stride, write.SourceCount, transform, write.Transform);
+	}
+	else
+	{
+		switch (write.FloatCount)
+		{
+		case 1: CopyStrided<1>(write.pSource, write.SourceCount, pDestination, stride); break;
+		case 2: CopyStrided<2>(write.pSource, write.SourceCount, pDestination, stride); break;
+		case 3: CopyStrided<3>(write.pSource, write.SourceCount, pDestination, stride); break;
+		default: CopyStrided<4>(write.pSource, write.SourceCount, pDestination, stride); break;
+		}
+	}
+	if (write.SourceCount == vertexCount)
+		return;
+
+	float fillValue[4]{};
+	if (write.SourceCount > 0)
+	{
+		const float* pLast = write.pSource + (write.SourceCount - 1) * write.FloatCount;
+		if (write.Transform != TransformType::None)
+			TransformVectors(pLast, write.FloatCount, fillValue, write.FloatCount, 1, transform, write.Transform);
+		else
+			memcpy(fillValue, pLast, write.FloatCount * sizeof(float));
+	}
+	pDestination += write.SourceCount * stride;
+	for (size_t i = write.SourceCount; i < vertexCount; i++)
+	{
+		memcpy(pDestination, fillValue, write.FloatCount * sizeof(float));
+		pDestination += stride;
+	}
+}
+
 float* Mesh::CreateVertices(const std::vector<VertexAttribute>& vertexTypes, float* allocatedMem, const glm::mat4x4& transform)
 {
-	std::map<VertexAttribute, size_t> vertexAttributeCounts;
-	size_t vertexCount = GetVertexAttributeCount(vertexTypes.front());
-	size_t stride = GetStride(vertexTypes);
+	const size_t vertexCount = GetVertexAttributeCount(vertexTypes.front());
+	const size_t stride = GetStride(vertexTypes) / sizeof(float);
+	const bool isTransformed = transform != glm::mat4x4(1.f);
 	size_t offset{};
 	for (VertexAttribute attributeType : vertexTypes)
 	{
-		float* writePos = allocatedMem + offset;
-		size_t vertexAttributeCount = GetVertexAttributeCount(attributeType);
-		size_t vertexAttributeSize = GetVertexTypeSize(attributeType);
-		for (size_t i = 0; i < vertexAttributeCount; i++)
-		{
-			WriteVertexAttribute(attributeType, i, writePos, transform);
-			writePos += stride/sizeof(float);
-		}
-		for (size_t i = vertexAttributeCount; i < vertexCount; i++)
-		{
-			if (m_ShouldFillVertexAttributes.end() == std::find(m_ShouldFillVertexAttributes.begin(), m_ShouldFillVertexAttributes.end(), attributeType))
-			{
-				assert(0 && "VertexAttribute length smaller then vertexcount! Set ShoulFillVertexAttribute=true if this was intentional");
-			}
-			WriteVertexAttribute(attributeType, vertexAttributeCount - 1, writePos, transform);
-			writePos += stride/sizeof(float);
-		}
-		offset += vertexAttributeSize/sizeof(float);
+		const VertexAttributeStream& stream = m_VertexAttributes[size_t(attributeType)];
+		AttributeWrite write{};
+		write.FloatCount = GetVertexTypeSize(attributeType) / sizeof(float);
+		write.pSource = stream.pData;
+		write.SourceCount = std::min(stream.FloatCount / write.FloatCount, vertexCount);
+		write.Transform = isTransformed ? GetTransformType(attributeType) : TransformType::None;
+		assert((write.SourceCount == vertexCount || m_ShouldFillVertexAttributes[size_t(attributeType)])
+			&& "VertexAttribute length smaller then vertexcount! Set ShoulFillVertexAttribute=true if this was intentional");
+		WriteStridedAttribute(write, vertexCount, allocatedMem + offset, stride, transform);
+		offset += write.FloatCount;
 	}
-	return allocatedMem + vertexCount*(stride/sizeof(float));
+	return allocatedMem + vertexCount * stride;
 }
 
 void Mesh::SetIndices(const std::vector<uint32_t>& indices)
@@ -64,75 +114,51 @@ const std::vector<uint32_t>& Mesh::GetIndices()
 
 uint32_t* Mesh::GetIndices(uint32_t vertexOffset, uint32_t* allocatedMem)
 {
-	std::vector<uint32_t> offsetIndices = m_Indices;
-	for (uint32_t& index : offsetIndices)
-	{
-		index += vertexOffset;
-	}
-	memcpy(allocatedMem, offsetIndices.data(), offsetIndices.size() * sizeof(uint32_t));
-	return allocatedMem + offsetIndices.size();
+	return OffsetIndices(m_Indices.data(), m_Indices.size(), vertexOffset, allocatedMem);
 }
 
-size_t Mesh::GetVertexCount(const std::vector<VertexAttribute>& attributeTypes)
+uint32_t* Mesh::GetIndices(uint32_t vertexOffset, uint32_t vertexStep, size_t copyCount, uint32_t* allocatedMem)
 {
-	return GetVertexAttributeCount(attributeTypes.front());
+	for (size_t i = 0; i < copyCount; i++)
+	{
+		allocatedMem = OffsetIndices(m_Indices.data(), m_Indices.size(), vertexOffset + uint32_t(i) * vertexStep, allocatedMem);
+	}
+	return allocatedMem;
 }
 
-size_t Mesh::GetIndexCount()
+uint16_t* Mesh::GetIndices(uint32_t vertexOffset, uint16_t* allocatedMem)
 {
-	return m_Indices.size();
+	return GetIndices(vertexOffset, 0, 1, allocatedMem);
 }
 
-
-void Mesh::WriteVertexAttribute(VertexAttribute attributeType, size_t idx, float* writePos, const glm::mat4x4& transform)
+uint16_t* Mesh::GetIndices(uint32_t vertexOffset, uint32_t vertexStep, size_t copyCount, uint16_t* allocatedMem)
 {
-	size_t attributeSize = GetVertexTypeSize(attributeType);
-	idx *= (attributeSize / sizeof(float));
-
-	memcpy(writePos, &m_VertexAttributes[attributeType][idx], attributeSize);
-	if(IsAffectedByTransform(attributeType) && transform != glm::mat4x4(1.f))
+	assert((m_Indices.empty() || copyCount == 0 || *std::max_element(m_Indices.begin(), m_Indices.end()) + vertexOffset + (copyCount - 1) * vertexStep <= 0xFFFF)
+		&& "Indices do not fit into 16 bits, check GetIndexType!");
+	for (size_t i = 0; i < copyCount; i++)
 	{
-		glm::vec4 attribute{};
-		assert(attributeSize > 2*sizeof(float) && "Attribute size is not supported for transform but is tagged as IsAffectedByTransform");
-		if(attributeSize == 3*sizeof(float))
-		{
-			attribute = glm::vec4(*(glm::vec3*)writePos, 1.f);
-		}else
-		if(attributeSize == 4*sizeof(float))
-		{
-			attribute = *(glm::vec4*)writePos;
-		}
-		attribute = transform * attribute;
-		memcpy(writePos, &attribute, attributeSize);
+		allocatedMem = OffsetIndices(m_Indices.data(), m_Indices.size(), vertexOffset + uint32_t(i) * vertexStep, allocatedMem);
 	}
+	return allocatedMem;
 }
 
+size_t Mesh::GetVertexCount(const std::vector<VertexAttribute>& attributeTypes)
+{
+	return GetVertexAttributeCount(attributeTypes.front());
+}
+
+size_t Mesh::GetIndexCount()
+{
+	return m_Indices.size();
+}
 
 
 void Mesh::SetFillVertexAttribute(VertexAttribute attributeType, bool shouldFill)
 {
-	if(shouldFill)
-	{
-		if (m_ShouldFillVertexAttributes.end() == std::find(m_ShouldFillVertexAttributes.begin(), m_ShouldFillVertexAttributes.end(), attributeType))
-		{
-			m_ShouldFillVertexAttributes.push_back(attributeType);
-		}
-	}
-	else
-	{
-		m_ShouldFillVertexAttributes.erase(std::remove(m_ShouldFillVertexAttributes.begin(), m_ShouldFillVertexAttributes.end(), attributeType), m_ShouldFillVertexAttributes.end());
-	}
+	m_ShouldFillVertexAttributes[size_t(attributeType)] = shouldFill;
 }
 
-
 size_t Mesh::GetVertexAttributeCount(VertexAttribute attributeType)
 {
-	size_t attributeSize = GetVertexTypeSize(attributeType);
-
-	auto attributesIt = m_VertexAttributes.find(attributeType);
-	if (attributesIt != m_VertexAttributes.end())
-	{
-		return attributesIt->second.size()/(attributeSize/sizeof(float));
-	}
-	return 0;
+	return m_VertexAttributes[size_t(attributeType)].FloatCount / (GetVertexTypeSize(attributeType) / sizeof(float));
 }
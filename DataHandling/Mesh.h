@@ -1,8 +1,22 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <Base/VertexTypes.h>
-#include <map>
+#include <Base/VertexTransform.h>
+
+//Data of one vertex attribute. The vector it was added with is kept alive by pOwner, so it is never copied into another type.
+struct VertexAttributeStream
+{
+	std::shared_ptr<const void>	pOwner{};
+	const float*				pData{};
+	size_t						FloatCount{};
+};
+
 class Mesh
 {
 public:
@@ -11,25 +25,52 @@ public:
 	//Usefull for batching multiple meshes into one vertexBuffer returns the next writepos;
 	float* CreateVertices(const std::vector<VertexAttribute>& vertexTypes, float* allocatedMem, const glm::mat4x4& transform = glm::mat4x4(1.f));
 	std::vector<float> CreateVertices(const std::vector<VertexAttribute>& vertexTypes, const glm::mat4x4& transform = glm::mat4x4(1.f));
+	//Same result, but the vertices are written one after the other by code generated for the layout, with every offset and size a constant.
+	//The transformed attributes are then transformed in place.
+	template<VertexAttribute... Attributes>
+	float* CreateVertices(VertexLayoutT<Attributes...> layout, float* allocatedMem, const glm::mat4x4& transform = glm::mat4x4(1.f));
 
 	//Usefull for batching all indices into one indexBuffer returns the next writepos;
 	uint32_t* GetIndices(uint32_t vertexOffset, uint32_t* allocatedMem);
+	//Writes copyCount copies of the indices in one call, copy i offset by vertexOffset + i * vertexStep. For batching copies of this mesh
+	//whose vertices follow each other, vertexStep is then the vertex count of the mesh.
+	uint32_t* GetIndices(uint32_t vertexOffset, uint32_t vertexStep, size_t copyCount, uint32_t* allocatedMem);
+	//Same with 16 bit indices, for batches of at most 65536 vertices, see GetIndexType.
+	uint16_t* GetIndices(uint32_t vertexOffset, uint16_t* allocatedMem);
+	uint16_t* GetIndices(uint32_t vertexOffset, uint32_t vertexStep, size_t copyCount, uint16_t* allocatedMem);
 	const std::vector<uint32_t>& GetIndices();
 
 	//Vertex count is based on the first attribute
 	size_t GetVertexCount(const std::vector<VertexAttribute>& attributeTypes);
 	size_t GetIndexCount();
 	size_t GetVertexDataSize(const std::vector<VertexAttribute>& attributeTypes);
+	template<VertexAttribute... Attributes>
+	size_t GetVertexCount(VertexLayoutT<Attributes...>)
+	{
+		const VertexAttribute attributes[] = { Attributes... };
+		return GetVertexAttributeCount(attributes[0]);
+	}
+	template<VertexAttribute... Attributes>
+	size_t GetVertexDataSize(VertexLayoutT<Attributes...> layout) { return GetVertexCount(layout) * VertexLayoutT<Attributes...>::Stride; }
+	//Narrowest index type for this mesh on its own, batches have to use the total vertex count instead.
+	IndexType GetIndexType(const std::vector<VertexAttribute>& attributeTypes) { return ::GetIndexType(GetVertexCount(attributeTypes)); }
 
 	void SetIndices(const std::vector<uint32_t>& indices);
 	template<typename T>
 	void AddVertexAttribute(VertexAttribute type, const std::vector<T>& data)
+	{
+		AddVertexAttribute(type, std::vector<T>(data));
+	}
+	//Takes over the vector without copying it.
+	template<typename T>
+	void AddVertexAttribute(VertexAttribute type, std::vector<T>&& data)
 	{
 		assert(GetVertexTypeSize(type) == sizeof(T) && "Vertex Attribute type does not have the same size as attributes passed!");
-		//Copies vector of any type into float vector
-		float* front = (float*)(&data[0]);
-		float* back = (float*)(&data[data.size()-1])+(sizeof(T)/sizeof(float));
-		m_VertexAttributes[type] = std::vector<float>(front, back);
+		std::shared_ptr<std::vector<T>> pData = std::make_shared<std::vector<T>>(std::move(data));
+		VertexAttributeStream& stream = m_VertexAttributes[size_t(type)];
+		stream.pData = reinterpret_cast<const float*>(pData->data());
+		stream.FloatCount = pData->size() * sizeof(T) / sizeof(float);
+		stream.pOwner = std::move(pData);
 	}
 
 	//If enabled this will fill vertex attribute data to match the length of the first vertexattribute with the last value passed in the vertexattributes data if no data was passed 0 initialized.
@@ -37,10 +78,82 @@ public:
 	
 private:
 	size_t GetVertexAttributeCount(VertexAttribute attributeType);
-	void WriteVertexAttribute(VertexAttribute attributeType, size_t idx, float* writePos, const glm::mat4x4& transform = glm::mat4x4(1.f));
+	//Writes count vertices, advancing every source by its step after each vertex.
+	template<VertexAttribute... Attributes, size_t... Indices>
+	static void WriteVertices(const float* const* ppSources, const size_t* pSteps, size_t count, float* pDestination, std::index_sequence<Indices...>);
 
-	std::vector<uint32_t>									m_Indices{};
-	std::map<VertexAttribute, std::vector<float>>			m_VertexAttributes{};
-
-	std::vector<VertexAttribute>							m_ShouldFillVertexAttributes{};
+	std::vector<uint32_t>		m_Indices{};
+	VertexAttributeStream		m_VertexAttributes[VertexAttributeCount]{};
+	bool						m_ShouldFillVertexAttributes[VertexAttributeCount]{};
 };
+
+template<VertexAttribute... Attributes>
+float* Mesh::CreateVertices(VertexLayoutT<Attributes...> layout, float* allocatedMem, const glm::mat4x4& transform)
+{
+	const size_t attributeCount = sizeof...(Attributes);
+	const size_t stride = VertexLayoutT<Attributes...>::Stride / sizeof(float);
+	const VertexAttribute attributes[] = { Attributes... };
+	const size_t floatCounts[] = { GetVertexTypeSize(Attributes) / sizeof(float)... };
+	const size_t vertexCount = GetVertexCount(layout);
+	size_t sourceCounts[attributeCount];
+	for (size_t i = 0; i < attributeCount; i++)
+	{
+		sourceCounts[i] = std::min(GetVertexAttributeCount(attributes[i]), vertexCount);
+		assert((sourceCounts[i] == vertexCount || m_ShouldFillVertexAttributes[size_t(attributes[i])])
+			&& "VertexAttribute length smaller then vertexcount! Set ShoulFillVertexAttribute=true if this was intentional");
+	}
+
+	//Vertices are written in runs in which every attribute either reads its next value or repeats its last one, 0 without any.
+	static const float zero[4]{};
+	for (size_t first = 0; first < vertexCount;)
+	{
+		size_t last = vertexCount;
+		const float* pSources[attributeCount];
+		size_t steps[attributeCount];
+		for (size_t i = 0; i < attributeCount; i++)
+		{
+			const float* pData = m_VertexAttributes[size_t(attributes[i])].pData;
+			if (first < sourceCounts[i])
+			{
+				last = std::min(last, sourceCounts[i]);
+				pSources[i] = pData + first * floatCounts[i];
+				steps[i] = floatCounts[i];
+			}
+			else
+			{
+				pSources[i] = sourceCounts[i] > 0 ? pData + (sourceCounts[i] - 1) * floatCounts[i] : zero;
+				steps[i] = 0;
+			}
+		}
+		float* pDestination = allocatedMem + first * stride;
+		WriteVertices<Attributes...>(pSources, steps, last - first, pDestination, std::make_index_sequence<attributeCount>());
+		first = last;
+	}
+
+	if (transform != glm::mat4x4(1.f))
+	{
+		const TransformType transformTypes[] = { GetTransformType(Attributes)... };
+		for (size_t i = 0; i < attributeCount; i++)
+		{
+			float* pAttribute = allocatedMem + VertexLayoutT<Attributes...>::GetOffset(i) / sizeof(float);
+			if (transformTypes[i] != TransformType::None)
+				TransformVectors(pAttribute, stride, pAttribute, stride, vertexCount, transform, transformTypes[i]);
+		}
+	}
+	return allocatedMem + vertexCount * stride;
+}
+
+template<VertexAttribute... Attributes, size_t... Indices>
+void Mesh::WriteVertices(const float* const* ppSources, const size_t* pSteps, size_t count, float* pDestination, std::index_sequence<Indices...>)
+{
+	const size_t stride = VertexLayoutT<Attributes...>::Stride / sizeof(float);
+	const float* pSources[] = { ppSources[Indices]... };
+	for (size_t i = 0; i < count; i++)
+	{
+		//Unrolled over the attributes, the offsets and sizes are template arguments so they are constants.
+		const int writes[] = { (memcpy(pDestination + std::integral_constant<size_t, GetLayoutOffset<Attributes...>(Indices) / sizeof(float)>::value,
+			pSources[Indices], GetVertexTypeSize(Attributes)), pSources[Indices] += pSteps[Indices], 0)... };
+		(void)writes;
+		pDestination += stride;
+	}
+}
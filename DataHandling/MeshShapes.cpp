@@ -69,8 +69,8 @@ Mesh* CreatePlaneMesh(float width, float height, const glm::ivec2& subdivision,
 	GeneratePlaneMeshVertexData(positions, uvs, width, height, subdivision);
 	GeneratePlaneMeshIndexData(indices, subdivision);
 
-	pPlane->AddVertexAttribute(VertexAttribute::POSITION, positions);
-	pPlane->AddVertexAttribute(VertexAttribute::UV, uvs);
+	pPlane->AddVertexAttribute(VertexAttribute::POSITION, std::move(positions));
+	pPlane->AddVertexAttribute(VertexAttribute::UV, std::move(uvs));
 	pPlane->AddVertexAttribute(VertexAttribute::NORMAL, std::vector<glm::vec3>{ {0, 0, -1} });
 	pPlane->AddVertexAttribute(VertexAttribute::COLOR, std::vector<glm::vec4>{color});
 	pPlane->SetFillVertexAttribute(VertexAttribute::NORMAL, true);
@@ -176,9 +176,9 @@ Mesh* CreateRectBox(float width, float height, float depth, glm::ivec2 subdivisi
 	std::fill(normalIt, normalIt + topPlanePositions.size(), glm::vec3{ 0, -1, 0 });
 
 	Mesh* pCubeMesh = new Mesh{};
-	pCubeMesh->AddVertexAttribute(VertexAttribute::POSITION, positions);
-	pCubeMesh->AddVertexAttribute(VertexAttribute::NORMAL, normals);
-	pCubeMesh->AddVertexAttribute(VertexAttribute::UV, uvs);
+	pCubeMesh->AddVertexAttribute(VertexAttribute::POSITION, std::move(positions));
+	pCubeMesh->AddVertexAttribute(VertexAttribute::NORMAL, std::move(normals));
+	pCubeMesh->AddVertexAttribute(VertexAttribute::UV, std::move(uvs));
 	pCubeMesh->AddVertexAttribute(VertexAttribute::COLOR, std::vector<glm::vec4>{ color });
 	pCubeMesh->SetFillVertexAttribute(VertexAttribute::COLOR, true);
 	pCubeMesh->SetIndices(indices);
@@ -0,0 +1,40 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 proj;
+    mat4 view;
+} ubo;
+
+//xyz: chunk position, w: size of a voxel of the mesh's level of detail
+layout(push_constant) uniform ChunkInfo {
+    vec4 position;
+} chunk;
+
+//xyz: chunk local position in voxels of the mesh, w: normal id
+layout(location = 0) in uvec4 inPositionNormal;
+layout(location = 1) in uint inMaterial;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+
+//Same face order as VoxelFaces in VoxelChunk.cpp
+const vec3 normals[6] = vec3[](
+    vec3( 1, 0, 0), vec3(-1, 0, 0),
+    vec3( 0, 1, 0), vec3( 0,-1, 0),
+    vec3( 0, 0, 1), vec3( 0, 0,-1)
+);
+
+const vec3 palette[4] = vec3[](
+    vec3(0.0, 0.0, 0.0),
+    vec3(0.3, 0.6, 0.0),
+    vec3(0.5, 0.4, 0.3),
+    vec3(0.6, 0.6, 0.6)
+);
+
+void main() {
+    vec3 worldPosition = chunk.position.xyz + vec3(inPositionNormal.xyz) * chunk.position.w;
+    gl_Position = ubo.proj * ubo.view * vec4(worldPosition, 1.0);
+    fragColor = palette[inMaterial % 4];
+    fragNormal = normals[inPositionNormal.w];
+}
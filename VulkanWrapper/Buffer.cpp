@@ -49,6 +49,54 @@ void vkw::Buffer::Update(void const * data, size_t size, CommandPool* cmdPool)
 
 }
 
+void vkw::Buffer::Update(void const* data, const std::vector<VkBufferCopy>& regions, CommandPool* pCommandPool)
+{
+	if (regions.empty())
+		return;
+
+	if (!m_UsingStagingBuffer)
+	{
+		void* pMappedMemory{};
+		ErrorCheck(vkMapMemory(m_pDevice->GetDevice(), m_Memory, 0, VK_WHOLE_SIZE, 0, &pMappedMemory));
+		for (const VkBufferCopy& region : regions)
+		{
+			memcpy(static_cast<char*>(pMappedMemory) + region.dstOffset, static_cast<char const*>(data) + region.srcOffset, region.size);
+		}
+		vkUnmapMemory(m_pDevice->GetDevice(), m_Memory);
+		return;
+	}
+
+	//Pack the regions back to back in the staging buffer.
+	std::vector<VkBufferCopy> stagingRegions{ regions };
+	VkDeviceSize stagingSize = 0;
+	for (VkBufferCopy& region : stagingRegions)
+	{
+		region.srcOffset = stagingSize;
+		stagingSize += region.size;
+	}
+
+	VkBuffer stagingBuffer{};
+	VkDeviceMemory stagingBufferMemory{};
+	CreateBuffer(
+		m_pDevice->GetDevice(), m_pDevice->GetPhysicalDeviceMemoryProperties(),
+		stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		stagingBuffer, stagingBufferMemory
+	);
+
+	void* pMappedMemory{};
+	ErrorCheck(vkMapMemory(m_pDevice->GetDevice(), stagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &pMappedMemory));
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		memcpy(static_cast<char*>(pMappedMemory) + stagingRegions[i].srcOffset, static_cast<char const*>(data) + regions[i].srcOffset, regions[i].size);
+	}
+	vkUnmapMemory(m_pDevice->GetDevice(), stagingBufferMemory);
+
+	CopyBuffer(pCommandPool, stagingBuffer, m_Buffer, stagingRegions);
+
+	vkFreeMemory(m_pDevice->GetDevice(), stagingBufferMemory, nullptr);
+	vkDestroyBuffer(m_pDevice->GetDevice(), stagingBuffer, nullptr);
+}
+
 const VkBuffer& vkw::Buffer::GetHandle() const
 {
 	return m_Buffer;
@@ -149,3 +197,10 @@ void vkw::Buffer::CopyBuffer(CommandPool* pCommandPool, VkBuffer srcBuffer, VkBu
 
 	pCommandPool->EndSingleTimeCommands(commandBuffer);
 }
+
+void vkw::Buffer::CopyBuffer(CommandPool* pCommandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy>& regions)
+{
+	VkCommandBuffer commandBuffer = pCommandPool->BeginSingleTimeCommands();
+	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, uint32_t(regions.size()), regions.data());
+	pCommandPool->EndSingleTimeCommands(commandBuffer);
+}
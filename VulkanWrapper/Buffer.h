@@ -1,5 +1,6 @@
 #pragma once
 #include "Platform.h"
+#include <vector>
 
 namespace vkw
 {
@@ -12,12 +13,15 @@ namespace vkw
 		~Buffer();
 
 		void Update(void const* data, size_t size, CommandPool* pCommandPool);
+		//Only copies the given regions, srcOffset is relative to data and dstOffset to the buffer. Staged regions are uploaded in a single copy.
+		void Update(void const* data, const std::vector<VkBufferCopy>& regions, CommandPool* pCommandPool);
 		const VkBuffer& GetHandle() const;
 		VkDescriptorBufferInfo GetDescriptor() const;
 		void Map();
 		void UnMap();
 		void* GetMappedMemory();
 		static void CopyBuffer(CommandPool* pCommandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t size);
+		static void CopyBuffer(CommandPool* pCommandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy>& regions);
 
 	private:
 		void Init(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memPropFlags, size_t size, void const* data, CommandPool* cmdPool);
@@ -9,7 +9,7 @@
 using namespace vkw;
 
 
-GraphicsPipeline::GraphicsPipeline(VulkanDevice* pDevice, RenderPass* pRenderPass, VkPipelineCache pipelineCache, VkDescriptorSetLayout descriptorSetLayout, const VertexLayout& vertexLayout, const std::string& vertexShader, const std::string& fragShader, VkPrimitiveTopology topology, VkFrontFace frontFace, bool wireframe)
+GraphicsPipeline::GraphicsPipeline(VulkanDevice* pDevice, RenderPass* pRenderPass, VkPipelineCache pipelineCache, VkDescriptorSetLayout descriptorSetLayout, const VertexLayout& vertexLayout, const std::string& vertexShader, const std::string& fragShader, VkPrimitiveTopology topology, VkFrontFace frontFace, bool wireframe, uint32_t vertexPushConstantSize)
 	:m_pDevice(pDevice)
 	,m_pRenderPass(pRenderPass)
 	,m_PipelineCache(pipelineCache)
@@ -20,6 +20,7 @@ GraphicsPipeline::GraphicsPipeline(VulkanDevice* pDevice, RenderPass* pRenderPas
 	,m_Topology(topology)
 	,m_FrontFace(frontFace)
 	,m_Wireframe(wireframe)
+	,m_VertexPushConstantSize(vertexPushConstantSize)
 {
 	Init();
 }
@@ -51,6 +52,15 @@ void vkw::GraphicsPipeline::Init()
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.pSetLayouts = &m_DescriptorSetLayout;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = m_VertexPushConstantSize;
+	if (m_VertexPushConstantSize > 0)
+	{
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+	}
 	ErrorCheck(vkCreatePipelineLayout(m_pDevice->GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_PipelineLayout));
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{};
@@ -10,7 +10,7 @@ namespace vkw
 	class GraphicsPipeline
 	{
 	public:
-		GraphicsPipeline(VulkanDevice* pDevice, RenderPass* pRenderPass, VkPipelineCache pipelineCache, VkDescriptorSetLayout descriptorSetLayout, const VertexLayout& vertexLayout, const std::string& vertexShader, const std::string& fragShader, VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE, bool wireFrame = false);
+		GraphicsPipeline(VulkanDevice* pDevice, RenderPass* pRenderPass, VkPipelineCache pipelineCache, VkDescriptorSetLayout descriptorSetLayout, const VertexLayout& vertexLayout, const std::string& vertexShader, const std::string& fragShader, VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE, bool wireFrame = false, uint32_t vertexPushConstantSize = 0);
 		~GraphicsPipeline();
 		VkPipelineLayout GetLayout();
 		VkPipeline GetPipeline();
@@ -33,6 +33,7 @@ namespace vkw
 		VkPrimitiveTopology			m_Topology{};
 		VkFrontFace					m_FrontFace{};
 		bool						m_Wireframe;
+		uint32_t					m_VertexPushConstantSize{};
 	};
 }
 
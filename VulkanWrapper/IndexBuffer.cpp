@@ -0,0 +1,67 @@
+#include "IndexBuffer.h"
+#include <algorithm>
+#include <cassert>
+
+static std::vector<uint16_t> NarrowIndices(uint32_t const* data, size_t size)
+{
+	std::vector<uint16_t> indices(size);
+	OffsetIndices(data, size, 0, indices.data());
+	return indices;
+}
+
+vkw::IndexBuffer::IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data)
+	:IndexBuffer(pDevice, cmdPool, size, data, IndexType::UINT32)
+{
+}
+
+vkw::IndexBuffer::IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data, size_t vertexCount)
+	:IndexBuffer(pDevice, cmdPool, size, data, ::GetIndexType(vertexCount))
+{
+	assert((size == 0 || *std::max_element(data, data + size) < vertexCount) && "Index out of the vertex range!");
+}
+
+vkw::IndexBuffer::IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint16_t const* data)
+	:m_Buffer(pDevice, cmdPool, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size * sizeof(uint16_t), data)
+	,m_IndexCount{ size }
+	,m_IndexType{ IndexType::UINT16 }
+{
+}
+
+//The narrowed copy only lives until the buffer has been uploaded.
+vkw::IndexBuffer::IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data, IndexType type)
+	:m_Buffer(pDevice, cmdPool, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size * GetIndexTypeSize(type),
+		type == IndexType::UINT16 ? static_cast<void const*>(NarrowIndices(data, size).data()) : data)
+	,m_IndexCount{ size }
+	,m_IndexType{ type }
+{
+}
+
+void vkw::IndexBuffer::Update(uint32_t const* pIndices, const std::vector<VkBufferCopy>& indexRegions, CommandPool* pCommandPool)
+{
+	const VkDeviceSize indexSize = GetIndexTypeSize(m_IndexType);
+	std::vector<VkBufferCopy> regions(indexRegions.size());
+	if (m_IndexType == IndexType::UINT32)
+	{
+		for (size_t i = 0; i < indexRegions.size(); i++)
+		{
+			regions[i] = { indexRegions[i].srcOffset * indexSize, indexRegions[i].dstOffset * indexSize, indexRegions[i].size * indexSize };
+		}
+		m_Buffer.Update(pIndices, regions, pCommandPool);
+		return;
+	}
+
+	//Only the regions are narrowed, packed one after the other.
+	size_t indexCount = 0;
+	for (const VkBufferCopy& region : indexRegions)
+	{
+		indexCount += size_t(region.size);
+	}
+	std::vector<uint16_t> indices(indexCount);
+	uint16_t* pWrite = indices.data();
+	for (size_t i = 0; i < indexRegions.size(); i++)
+	{
+		regions[i] = { (pWrite - indices.data()) * indexSize, indexRegions[i].dstOffset * indexSize, indexRegions[i].size * indexSize };
+		pWrite = OffsetIndices(pIndices + indexRegions[i].srcOffset, size_t(indexRegions[i].size), 0, pWrite);
+	}
+	m_Buffer.Update(indices.data(), regions, pCommandPool);
+}
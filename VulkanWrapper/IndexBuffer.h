@@ -1,5 +1,6 @@
 #pragma once
 #include "Buffer.h"
+#include <Base/VertexTypes.h>
 namespace vkw
 {
 	class VulkanDevice;
@@ -7,16 +8,21 @@ namespace vkw
 	class IndexBuffer
 	{
 	public:
-		IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data)
-			:m_Buffer(pDevice, cmdPool, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size*sizeof(uint32_t), data)
-		{
-			m_IndexCount = size;
-		}
-		const Buffer& GetBuffer() { return m_Buffer; }
+		IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data);
+		//Stores the indices in 16 bits whenever vertexCount allows it, which halves the memory and bandwidth of the buffer.
+		IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data, size_t vertexCount);
+		IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint16_t const* data);
+		Buffer& GetBuffer() { return m_Buffer; }
 		size_t GetIndexCount() { return m_IndexCount; }
+		VkIndexType GetIndexType() const { return m_IndexType == IndexType::UINT16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+		//Copies the given regions of pIndices, narrowed to the index type of the buffer. Offsets and sizes of the regions are in indices.
+		void Update(uint32_t const* pIndices, const std::vector<VkBufferCopy>& indexRegions, CommandPool* pCommandPool);
 
 	private:
+		IndexBuffer(VulkanDevice* pDevice, CommandPool* cmdPool, size_t size, uint32_t const* data, IndexType type);
+
 		Buffer			m_Buffer;
 		size_t			m_IndexCount = 0;
+		IndexType		m_IndexType = IndexType::UINT32;
 	};
-}
\ No newline at end of file
+}
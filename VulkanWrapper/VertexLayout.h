@@ -3,19 +3,67 @@
 #include <vector>
 #pragma once
 #include <Base/VertexTypes.h>
+#include <cassert>
+#include <iterator>
+#include <utility>
 namespace vkw
 {
+	constexpr VkFormat GetVertexFormat(VertexAttribute type)
+	{
+		switch (type)
+		{
+		case VertexAttribute::UINT:
+			return VK_FORMAT_R32_UINT;
+		case VertexAttribute::UBYTE4:
+			return VK_FORMAT_R8G8B8A8_UINT;
+		default:
+			break;
+		}
+		switch (GetVertexTypeSize(type))
+		{
+		case 1 * sizeof(float):
+			return VK_FORMAT_R32_SFLOAT;
+		case 2 * sizeof(float):
+			return VK_FORMAT_R32G32_SFLOAT;
+		case 3 * sizeof(float):
+			return VK_FORMAT_R32G32B32_SFLOAT;
+		case 4 * sizeof(float):
+			return VK_FORMAT_R32G32B32A32_SFLOAT;
+		default:
+			assert(0 && "Unsupported vertextype size! Supported vertextype sizes are 1, 2, 3 and 4!");
+			return VK_FORMAT_UNDEFINED;
+		}
+	}
+
 	class VertexLayout
 	{
 	public:
 
 		VertexLayout(const std::vector<VertexAttribute>& layout);
+		//Stride and attribute descriptions are computed at compile time.
+		template<VertexAttribute... Attributes>
+		VertexLayout(VertexLayoutT<Attributes...>)
+			:m_Stride{ uint32_t(VertexLayoutT<Attributes...>::Stride) }
+			,m_Layout{ Attributes... }
+			,m_AttributeDescriptions(GetAttributeDescriptions<Attributes...>(std::make_index_sequence<sizeof...(Attributes)>()))
+		{
+		}
 
 		uint32_t GetStride();
 		const std::vector<VertexAttribute>& GetLayout();
 		const VkPipelineVertexInputStateCreateInfo& CreateVertexDescription();
 
 	private:
+		template<VertexAttribute... Attributes, size_t... Indices>
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(std::index_sequence<Indices...>)
+		{
+			static constexpr VkVertexInputAttributeDescription descriptions[] =
+			{
+				{ uint32_t(Indices), 0, GetVertexFormat(Attributes), uint32_t(GetLayoutOffset<Attributes...>(Indices)) }...
+			};
+			return { std::begin(descriptions), std::end(descriptions) };
+		}
+
 		uint32_t m_Stride{};
 		std::vector<VertexAttribute> m_Layout{};
 		std::vector<VkVertexInputAttributeDescription> m_AttributeDescriptions{};